@@ -20,29 +20,24 @@ int chksumfile_byinumber(struct unixfilesystem *fs, int inumber, void *chksum) {
     return -1;
   }
 
-  struct inode in;
-  int err = inode_iget(fs, inumber, &in);
-  if (err < 0) {
-    return err;
-  }
-
-  if (!(in.i_mode & IALLOC)) {
-    // The inode isn't allocated, so we can't hash it.
+  // Fails if the inode can't be read or isn't allocated, so we can't hash it.
+  // The block map is resolved once here instead of once per block.
+  struct filehandle *file = file_open(fs, inumber);
+  if (file == NULL) {
     return -1;
   }
 
-  int size = inode_getsize(&in);
-  for (int offset = 0; offset < size; offset += DISKIMG_SECTOR_SIZE) {
-    char buf[DISKIMG_SECTOR_SIZE];
-    int bno = offset/DISKIMG_SECTOR_SIZE;
-
-    int bytesMoved = file_getblock(fs, inumber, bno, buf);
-    if (bytesMoved < 0)
-      return -1;
-
-    if (!SHA1_Update(&shactx, buf, bytesMoved))
+  int bytesMoved;
+  char buf[64 * DISKIMG_SECTOR_SIZE];
+  while ((bytesMoved = file_read(file, buf, sizeof(buf))) > 0) {
+    if (!SHA1_Update(&shactx, buf, bytesMoved)) {
+      file_close(file);
       return -1;
+    }
   }
+  file_close(file);
+  if (bytesMoved < 0)
+    return -1;
 
   if (!SHA1_Final(chksum, &shactx))
     return -1;
@@ -2,6 +2,7 @@
 #include "inode.h"
 #include "diskimg.h"
 #include "file.h"
+#include "dirindex.h"
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -15,7 +16,9 @@
  *   - dirinumber: número de inode del directorio donde buscar (≥ 1)
  *   - dirEnt:     salida, puntero a direntv6 donde copiar la entrada encontrada
  *
- * Recorre todos los bloques del directorio y compara cada direntv6.
+ * Busca el nombre en el índice hash del directorio, que se arma al primer
+ * acceso y queda en fs. Si no se puede armar (error de lectura o falta de
+ * memoria), recorre todos los bloques del directorio y compara cada direntv6.
  * Devuelve  0  si encontró el nombre y llenó *dirEnt,
  *         -1  en caso de error (punteros nulos, inode no asignado, no es directorio, etc.),
  *          1  si no existe la entrada.
@@ -37,34 +40,46 @@ int directory_findname(struct unixfilesystem *fs,
     }
 
     /* 3) Obtener y validar inode del directorio */
-    struct inode in;
-    if (inode_iget(fs, dirinumber, &in) < 0) {
+    struct inode scratch;
+    const struct inode *in = inode_iget_ptr(fs, dirinumber, &scratch);
+    if (in == NULL) {
         return -1;
     }
     /* Debe estar asignado */
-    if ((in.i_mode & IALLOC) == 0) {
+    if ((in->i_mode & IALLOC) == 0) {
         return -1;
     }
     /* Debe ser directorio */
-    if ((in.i_mode & IFMT) != IFDIR) {
+    if ((in->i_mode & IFMT) != IFDIR) {
         return -1;
     }
 
-    /* 4) Calcular cantidad de bloques que ocupa el directorio */
-    int dirsize   = inode_getsize(&in);
-    int numBlocks = (dirsize + DISKIMG_SECTOR_SIZE - 1)
-                    / DISKIMG_SECTOR_SIZE;
+    /* 4) Buscar en el índice del directorio */
+    int found = dirindex_lookup(fs, dirinumber, name, dirEnt);
+    if (found == 0) {
+        return 0;
+    }
+    if (found == 1) {
+        return -1;     /* no existe en el directorio */
+    }
+
+    /* Sin índice: abrir el directorio, su mapa de bloques se resuelve una sola vez */
+    struct filehandle *dir = file_open(fs, dirinumber);
+    if (dir == NULL) {
+        return -1;
+    }
 
-    /* 5) Recorrer cada bloque con file_getblock */
-    for (int bno = 0; bno < numBlocks; bno++) {
+    /* 5) Recorrer cada bloque con file_read */
+    for (;;) {
         char buf[DISKIMG_SECTOR_SIZE];
-        int bytes = file_getblock(fs, dirinumber, bno, buf);
+        int bytes = file_read(dir, buf, DISKIMG_SECTOR_SIZE);
         if (bytes < 0) {
+            file_close(dir);
             return -1;     /* error de lectura */
         }
-        /* Si bloque no asignado o fuera de rango, bytes==0, entonces seguimos */
+        /* Fin del directorio */
         if (bytes == 0) {
-            continue;
+            break;
         }
 
         /* 6) Iterar sobre cada entrada válida en el bloque */
@@ -82,11 +97,13 @@ int directory_findname(struct unixfilesystem *fs,
             {
                 /* 7) Copiar resultado y salir */
                 *dirEnt = entries[i];
+                file_close(dir);
                 return 0;
             }
         }
     }
 
     /* 8) No encontrado */
+    file_close(dir);
     return -1;
 }
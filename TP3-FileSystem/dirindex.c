@@ -0,0 +1,209 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "dirindex.h"
+#include "file.h"
+
+#define NAME_LEN         sizeof(((struct direntv6 *)0)->d_name)
+#define DIRINDEX_BUCKETS 1024   // buckets de la tabla de directorios (potencia de 2)
+
+/**
+ * Índice de un directorio: tabla hash con direccionamiento abierto cuyos
+ * slots apuntan a entries[]. La clave de cada entrada es su nombre hasta el
+ * primer '\0', completado con ceros hasta NAME_LEN bytes.
+ */
+struct dirindex {
+  int inumber;                  // directorio indexado
+  int count;                    // entradas indexadas
+  struct indexedentry {
+    char key[NAME_LEN];
+    struct direntv6 ent;        // la entrada tal cual está en el disco
+  } *entries;
+  int *slots;                   // índice en entries[] o -1 si el slot está libre
+  unsigned int slotMask;        // cantidad de slots - 1 (potencia de 2)
+  struct dirindex *next;        // siguiente en el mismo bucket de la caché
+};
+
+struct dirindexcache {
+  struct dirindex *buckets[DIRINDEX_BUCKETS];  // índices ya armados, por inumber
+  pthread_mutex_t lock;                        // protege buckets
+};
+
+struct dirindexcache *dirindexcache_create(void)
+{
+    struct dirindexcache *cache = calloc(1, sizeof(struct dirindexcache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+static void dirindex_free(struct dirindex *index)
+{
+    free(index->entries);
+    free(index->slots);
+    free(index);
+}
+
+void dirindexcache_destroy(struct dirindexcache *cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+    for (int b = 0; b < DIRINDEX_BUCKETS; b++) {
+        struct dirindex *index = cache->buckets[b];
+        while (index != NULL) {
+            struct dirindex *next = index->next;
+            dirindex_free(index);
+            index = next;
+        }
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+/* FNV-1a sobre los NAME_LEN bytes de la clave */
+static unsigned int hash_key(const char *key)
+{
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < NAME_LEN; i++) {
+        h = (h ^ (unsigned char)key[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* Devuelve el slot donde está key, o el slot libre donde iría */
+static int find_slot(const struct dirindex *index, const char *key)
+{
+    unsigned int s = hash_key(key) & index->slotMask;
+    while (index->slots[s] >= 0
+           && memcmp(index->entries[index->slots[s]].key, key, NAME_LEN) != 0) {
+        s = (s + 1) & index->slotMask;
+    }
+    return s;
+}
+
+/**
+ * Lee el directorio dirinumber completo y arma su índice. Las entradas
+ * libres (d_inumber == 0) no se indexan y, si un nombre aparece más de una
+ * vez, queda la primera, igual que al recorrer el directorio.
+ * Devuelve NULL si no se pudo leer el directorio o no hay memoria.
+ */
+static struct dirindex *build_index(struct unixfilesystem *fs, int dirinumber)
+{
+    struct filehandle *dir = file_open(fs, dirinumber);
+    if (dir == NULL) {
+        return NULL;
+    }
+    int size = file_size(dir);
+    int nentries = size / sizeof(struct direntv6);
+    struct direntv6 *raw = malloc((nentries > 0 ? nentries : 1) * sizeof(struct direntv6));
+    struct dirindex *index = calloc(1, sizeof(struct dirindex));
+    int ok = raw != NULL && index != NULL
+             && file_read(dir, raw, nentries * sizeof(struct direntv6))
+                == (int)(nentries * sizeof(struct direntv6));
+    file_close(dir);
+
+    /* Al menos dos slots por entrada para que las búsquedas sean cortas */
+    unsigned int nslots = 2;
+    while (nslots < 2 * (unsigned int)nentries) {
+        nslots <<= 1;
+    }
+    if (ok) {
+        index->inumber  = dirinumber;
+        index->slotMask = nslots - 1;
+        index->entries  = malloc((nentries > 0 ? nentries : 1) * sizeof(struct indexedentry));
+        index->slots    = malloc(nslots * sizeof(int));
+        ok = index->entries != NULL && index->slots != NULL;
+    }
+    if (!ok) {
+        free(raw);
+        if (index != NULL) {
+            dirindex_free(index);
+        }
+        return NULL;
+    }
+
+    memset(index->slots, -1, nslots * sizeof(int));
+    for (int i = 0; i < nentries; i++) {
+        if (raw[i].d_inumber == 0) {
+            continue;
+        }
+        struct indexedentry *e = &index->entries[index->count];
+        memset(e->key, 0, NAME_LEN);
+        memcpy(e->key, raw[i].d_name, strnlen(raw[i].d_name, NAME_LEN));
+        e->ent = raw[i];
+        int s = find_slot(index, e->key);
+        if (index->slots[s] < 0) {
+            index->slots[s] = index->count++;
+        }
+    }
+    free(raw);
+    return index;
+}
+
+/**
+ * dirindex_lookup:
+ *   - fs:         sistema de archivos abierto
+ *   - dirinumber: número de inode del directorio (asignado y directorio)
+ *   - name:       nombre a buscar (longitud entre 1 y NAME_LEN)
+ *   - dirEnt:     salida, la entrada encontrada
+ *
+ * Busca el índice del directorio en la caché del sistema de archivos y, si
+ * no está, lo arma sin tener tomado el lock (si otro hilo lo armó mientras
+ * tanto, se usa el suyo). Un índice publicado no se modifica más, así que
+ * se puede consultar sin el lock.
+ * Devuelve 0 si encontró el nombre, 1 si no existe y -1 si no hay índice.
+ */
+int dirindex_lookup(struct unixfilesystem *fs, int dirinumber, const char *name,
+                    struct direntv6 *dirEnt)
+{
+    struct dirindexcache *cache = fs->dirs;
+    if (cache == NULL) {
+        return -1;
+    }
+
+    /* 1) Buscar el índice ya armado */
+    struct dirindex **bucket = &cache->buckets[(unsigned int)dirinumber & (DIRINDEX_BUCKETS - 1)];
+    pthread_mutex_lock(&cache->lock);
+    struct dirindex *index = *bucket;
+    while (index != NULL && index->inumber != dirinumber) {
+        index = index->next;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    /* 2) Si no está, armarlo y publicarlo */
+    if (index == NULL) {
+        struct dirindex *built = build_index(fs, dirinumber);
+        if (built == NULL) {
+            return -1;
+        }
+        pthread_mutex_lock(&cache->lock);
+        index = *bucket;
+        while (index != NULL && index->inumber != dirinumber) {
+            index = index->next;
+        }
+        if (index == NULL) {
+            built->next = *bucket;
+            *bucket = built;
+            index = built;
+            built = NULL;
+        }
+        pthread_mutex_unlock(&cache->lock);
+        if (built != NULL) {
+            dirindex_free(built);
+        }
+    }
+
+    /* 3) Una sola búsqueda en la tabla hash */
+    char key[NAME_LEN];
+    memset(key, 0, NAME_LEN);
+    memcpy(key, name, strnlen(name, NAME_LEN));
+    int s = find_slot(index, key);
+    if (index->slots[s] < 0) {
+        return 1;
+    }
+    *dirEnt = index->entries[index->slots[s]].ent;
+    return 0;
+}
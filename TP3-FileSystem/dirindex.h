@@ -0,0 +1,36 @@
+#ifndef _DIRINDEX_H_
+#define _DIRINDEX_H_
+
+#include "unixfilesystem.h"
+#include "direntv6.h"
+
+/**
+ * Hash indexes of directory entries by name, so that looking up a name in
+ * a directory is one probe instead of a scan of all its entries.  The index
+ * of a directory is built the first time a name is looked up in it and kept
+ * in a struct dirindexcache hung off the filesystem until it is freed (the
+ * directories are assumed not to change while the filesystem is in use).
+ * Lookups may run concurrently from several threads.
+ */
+struct dirindexcache;
+
+/**
+ * Creates an empty cache of directory indexes.  Returns NULL if out of memory.
+ */
+struct dirindexcache *dirindexcache_create(void);
+
+/**
+ * Frees a cache and all its indexes.  NULL is ignored.
+ */
+void dirindexcache_destroy(struct dirindexcache *cache);
+
+/**
+ * Looks up name in the index of directory dirinumber (an allocated
+ * directory), building the index if needed.  Returns 0 and fills *dirEnt
+ * with the first entry with that name, 1 if there is no such entry, or -1
+ * if the index could not be built (the caller should scan the directory).
+ */
+int dirindex_lookup(struct unixfilesystem *fs, int dirinumber, const char *name,
+                    struct direntv6 *dirEnt);
+
+#endif // _DIRINDEX_H_
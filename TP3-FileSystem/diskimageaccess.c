@@ -4,6 +4,7 @@
 #include <assert.h>
 #include <string.h>
 #include <getopt.h>
+#include <pthread.h>
 
 #include "diskimg.h"
 #include "unixfilesystem.h"
@@ -16,16 +17,21 @@
 int quietFlag = 0; 
 int idumpFlag = 0;
 int pdumpFlag = 0;
+int numThreads = 1;
 
 static void PrintDirectory(struct unixfilesystem *fs,  char *pathname);
 static void DumpInodeChecksum(struct unixfilesystem *fs, FILE *f);
 static void DumpPathnameChecksum(struct unixfilesystem *fs, FILE *f);
+static void DumpInodeChecksumParallel(struct unixfilesystem *fs, FILE *f);
+static void DumpPathnameChecksumParallel(struct unixfilesystem *fs, FILE *f);
 static void PrintUsageAndExit(char *progname);
 static int GetDirEntries(struct unixfilesystem *fs, int inumber, struct direntv6 *entries, int maxNumEntries);
+static int ReadDirEntries(struct unixfilesystem *fs, int inumber, struct direntv6 *entries, int maxNumEntries,
+                          int *readError);
 
 int main(int argc, char *argv[]) {
   int opt;
-  while ((opt = getopt(argc, argv, "iqp")) != -1) {
+  while ((opt = getopt(argc, argv, "iqpj:")) != -1) {
     switch (opt) {
     case 'q':
       quietFlag = 1;
@@ -36,6 +42,10 @@ int main(int argc, char *argv[]) {
     case 'p':
       pdumpFlag = 1;
       break;
+    case 'j':
+      numThreads = atoi(optarg);
+      if (numThreads < 1) PrintUsageAndExit(argv[0]);
+      break;
     default: 
       PrintUsageAndExit(argv[0]);
     } 
@@ -52,6 +62,9 @@ int main(int argc, char *argv[]) {
     fprintf(stderr, "Can't open diskimagePath %s\n", diskpath);
     exit(EXIT_FAILURE);
   }
+  // Read the image through a memory mapping when possible; if it can't be
+  // mapped it is read sector by sector, as usual.
+  (void) diskimg_map(fd);
 
   struct unixfilesystem *fs = unixfilesystem_init(fd);
   if (!fs) {
@@ -66,7 +79,7 @@ int main(int argc, char *argv[]) {
       // Cast the result of diskimg_close to void so the compiler doesn't
       // complain that we're ignoring its return value.
       (void) diskimg_close(fd);
-      free(fs);
+      unixfilesystem_free(fs);
       exit(EXIT_FAILURE);
     }
     printf("Disk %s is %d bytes (%d KB)\n", argv[1],  disksize, disksize/1024);
@@ -76,12 +89,17 @@ int main(int argc, char *argv[]) {
     printf("Superblock s_ninode %d\n",(int)fs->superblock.s_ninode);
   }
 
-  if (idumpFlag) DumpInodeChecksum(fs, stdout);
-  if (pdumpFlag) DumpPathnameChecksum(fs, stdout);
+  if (numThreads > 1) {
+    if (idumpFlag) DumpInodeChecksumParallel(fs, stdout);
+    if (pdumpFlag) DumpPathnameChecksumParallel(fs, stdout);
+  } else {
+    if (idumpFlag) DumpInodeChecksum(fs, stdout);
+    if (pdumpFlag) DumpPathnameChecksum(fs, stdout);
+  }
 
   int err = diskimg_close(fd);
   if (err < 0) fprintf(stderr, "Error closing %s\n", argv[1]);
-  free(fs);
+  unixfilesystem_free(fs);
   exit(EXIT_SUCCESS);
   return 0;
 }
@@ -193,6 +211,245 @@ static void DumpPathnameChecksum(struct unixfilesystem *fs, FILE *f) {
   DumpPathAndChildren(fs, "/", ROOT_INUMBER, f);
 }
 
+/**
+ * Parallel versions of the dumps above (-j N). The work is split in two:
+ * first the inodes (or the naming hierarchy) are scanned serially to build
+ * the list of checksums to compute, in output order; then numThreads worker
+ * threads compute them, all reading through the same struct unixfilesystem
+ * (its read paths are safe for concurrent readers); finally the results are
+ * printed in order. The naming scan checksums each directory before reading
+ * its entries, so it visits exactly the paths the serial dump visits, and
+ * the messages it would print are recorded and printed in order. The output,
+ * errors included, is the same as with the serial dumps.
+ */
+
+#define JOB_PENDING      0   // not computed yet
+#define JOB_OK           1
+#define JOB_NO_CHKSUM    2   // can't compute the checksum (by inumber or pathname)
+#define JOB_DIFFERS      3   // pathname and inumber checksums differ
+#define JOB_NO_INODE     4   // can't read the inode (found while scanning)
+#define JOB_NOT_ALLOC    5   // the inode is not allocated (found while scanning)
+
+struct chksumjob {
+  int inumber;
+  char *pathname;           // NULL in the inode dump
+  int tooDeep;              // print the "Too deep" warning after this one
+  int dirReadError;         // print the "Error reading directory" message after this one
+  int dirBadSize;           // the directory size is not a whole number of entries
+  struct inode in;
+  int status;
+  char chksumstring[CHKSUMFILE_STRINGSIZE];
+};
+
+struct chksumjobs {
+  struct chksumjob *jobs;
+  int count;
+  int capacity;
+  int next;                 // next job to hand out to a worker
+  struct unixfilesystem *fs;
+};
+
+static struct chksumjob *AddJob(struct chksumjobs *jobs) {
+  if (jobs->count == jobs->capacity) {
+    int capacity = jobs->capacity ? 2 * jobs->capacity : 256;
+    struct chksumjob *grown = realloc(jobs->jobs, capacity * sizeof(struct chksumjob));
+    if (grown == NULL) {
+      fprintf(stderr, "Out of memory.\n");
+      exit(EXIT_FAILURE);
+    }
+    jobs->jobs = grown;
+    jobs->capacity = capacity;
+  }
+  struct chksumjob *job = &jobs->jobs[jobs->count++];
+  memset(job, 0, sizeof(*job));
+  return job;
+}
+
+static void FreeJobs(struct chksumjobs *jobs) {
+  for (int i = 0; i < jobs->count; i++) free(jobs->jobs[i].pathname);
+  free(jobs->jobs);
+}
+
+static void ComputeJob(struct unixfilesystem *fs, struct chksumjob *job) {
+  char chksum1[CHKSUMFILE_SIZE];
+  if (chksumfile_byinumber(fs, job->inumber, chksum1) < 0) {
+    job->status = JOB_NO_CHKSUM;
+    return;
+  }
+  if (job->pathname != NULL) {
+    char chksum2[CHKSUMFILE_SIZE];
+    if (chksumfile_bypathname(fs, job->pathname, chksum2) < 0) {
+      job->status = JOB_NO_CHKSUM;
+      return;
+    }
+    if (!chksumfile_compare(chksum1, chksum2)) {
+      job->status = JOB_DIFFERS;
+      return;
+    }
+  }
+  chksumfile_cvt2string(chksum1, job->chksumstring);
+  job->status = JOB_OK;
+}
+
+static void *ChksumWorker(void *arg) {
+  struct chksumjobs *jobs = arg;
+  for (;;) {
+    int i = __sync_fetch_and_add(&jobs->next, 1);
+    if (i >= jobs->count) break;
+    if (jobs->jobs[i].status == JOB_PENDING) ComputeJob(jobs->fs, &jobs->jobs[i]);
+  }
+  return NULL;
+}
+
+/**
+ * Computes every pending job on numThreads threads. If a thread can't be
+ * started the others take its share; if none can, the jobs are computed
+ * here.
+ */
+static void RunJobs(struct chksumjobs *jobs) {
+  pthread_t *threads = malloc(numThreads * sizeof(pthread_t));
+  int started = 0;
+  jobs->next = 0;
+  for (int t = 0; threads != NULL && t < numThreads; t++) {
+    if (pthread_create(&threads[started], NULL, ChksumWorker, jobs) == 0) started++;
+  }
+  for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+  free(threads);
+  if (started == 0) ChksumWorker(jobs);
+}
+
+static void DumpInodeChecksumParallel(struct unixfilesystem *fs, FILE *f) {
+  struct chksumjobs jobs = { NULL, 0, 0, 0, fs };
+  int unreadable = -1;
+  for (int inumber = 1; inumber < fs->superblock.s_isize*16; inumber++) {
+    struct inode in;
+    if (inode_iget(fs, inumber, &in) < 0) {
+      unreadable = inumber;
+      break;
+    }
+    if ((in.i_mode & IALLOC) == 0) continue;
+    struct chksumjob *job = AddJob(&jobs);
+    job->inumber = inumber;
+    job->in = in;
+  }
+
+  RunJobs(&jobs);
+
+  for (int i = 0; i < jobs.count; i++) {
+    struct chksumjob *job = &jobs.jobs[i];
+    if (job->status != JOB_OK) {
+      fprintf(stderr, "Inode %d can't compute chksum\n", job->inumber);
+      continue;
+    }
+    fprintf(f, "Inode %d mode 0x%x size %d checksum %s\n", job->inumber, job->in.i_mode,
+            inode_getsize(&job->in), job->chksumstring);
+  }
+  if (unreadable >= 0) fprintf(stderr,"Can't read inode %d \n", unreadable);
+  FreeJobs(&jobs);
+}
+
+/**
+ * Adds pathname and, if it is a directory, all its children to jobs in the
+ * order DumpPathAndChildren visits them. Like DumpPathAndChildren, it only
+ * descends into a directory once both its checksums are known to be good,
+ * so directories are checksummed here and only files are left pending.
+ */
+static void AddPathAndChildren(struct unixfilesystem *fs, const char *pathname, int inumber,
+                               struct chksumjobs *jobs) {
+  struct chksumjob *job = AddJob(jobs);
+  job->inumber = inumber;
+  job->pathname = strdup(pathname);
+  if (job->pathname == NULL) {
+    fprintf(stderr, "Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (inode_iget(fs, inumber, &job->in) < 0) {
+    job->status = JOB_NO_INODE;
+    return;
+  }
+  if ((job->in.i_mode & IALLOC) == 0) {
+    /* The assert fails when the results are printed, where the serial dump fails */
+    job->status = JOB_NOT_ALLOC;
+    return;
+  }
+  if ((job->in.i_mode & IFMT) != IFDIR) {
+    return;
+  }
+
+  ComputeJob(fs, job);
+  if (job->status != JOB_OK) {
+    return;
+  }
+
+  if (pathname[1] == 0) {
+    /* pathame == "/" */
+    pathname++; /* Delete extra / character */
+  }
+
+  const unsigned int MAXPATH = 1024;
+  if (strlen(pathname) > MAXPATH-16) {
+    job->tooDeep = 1;
+  }
+
+  if (inode_getsize(&job->in) % sizeof(struct direntv6) != 0) {
+    /* GetDirEntries' assert fails when the results are printed */
+    job->dirBadSize = 1;
+    return;
+  }
+
+  struct direntv6 direntries[10000];
+  int readError = 0;
+  int numentries = ReadDirEntries(fs, inumber, direntries, 10000, &readError);
+  job->dirReadError = readError;
+  for (int i = 0; i < numentries; i++) {
+    char *n =  direntries[i].d_name;
+    if (n[0] == '.') {
+      if ((n[1] == 0) || ((n[1] == '.') && (n[2] == 0))) {
+        /* Skip over "." and ".." */
+        continue;
+      }
+    }
+
+    char nextpath[MAXPATH];
+    sprintf(nextpath, "%s/%s",pathname, direntries[i].d_name);
+    AddPathAndChildren(fs, nextpath, direntries[i].d_inumber, jobs);
+  }
+}
+
+static void DumpPathnameChecksumParallel(struct unixfilesystem *fs, FILE *f) {
+  struct chksumjobs jobs = { NULL, 0, 0, 0, fs };
+  AddPathAndChildren(fs, "/", ROOT_INUMBER, &jobs);
+
+  RunJobs(&jobs);
+
+  for (int i = 0; i < jobs.count; i++) {
+    struct chksumjob *job = &jobs.jobs[i];
+    if (job->status == JOB_NO_INODE) {
+      fprintf(stderr,"Can't read inode %d \n", job->inumber);
+      continue;
+    }
+    assert(job->in.i_mode & IALLOC);
+    if (job->status == JOB_DIFFERS) {
+      fprintf(stderr,"Pathname checksum of %s differs from inode %d\n", job->pathname, job->inumber);
+      continue;
+    }
+    if (job->status != JOB_OK) {
+      fprintf(stderr,"Can't checksum inode %d path %s\n", job->inumber, job->pathname);
+      continue;
+    }
+    fprintf(f, "Path %s %d mode 0x%x size %d checksum %s\n", job->pathname, job->inumber,
+            job->in.i_mode, inode_getsize(&job->in), job->chksumstring);
+    if (job->tooDeep) {
+      fprintf(stderr, "Too deep of directories %s\n", job->pathname);
+    }
+    assert(!job->dirBadSize);
+    if (job->dirReadError) {
+      fprintf(stderr, "Error reading directory\n");
+    }
+  }
+  FreeJobs(&jobs);
+}
+
 /**
  * Print all the entries in the specified directory. 
  */
@@ -220,6 +477,21 @@ static void PrintDirectory(struct unixfilesystem *fs,  char *pathname) {
  * number of entries found. 
  */
 static int GetDirEntries(struct unixfilesystem *fs, int inumber, struct direntv6 *entries, int maxNumEntries) {
+  int readError = 0;
+  int count = ReadDirEntries(fs, inumber, entries, maxNumEntries, &readError);
+  if (readError) {
+    fprintf(stderr, "Error reading directory\n");
+  }
+  return count;
+}
+
+/**
+ * Same as GetDirEntries, but instead of printing an error when a block of
+ * the directory can't be read it sets *readError, so that the parallel dump
+ * can print it in order.
+ */
+static int ReadDirEntries(struct unixfilesystem *fs, int inumber, struct direntv6 *entries, int maxNumEntries,
+                          int *readError) {
   struct inode in;
   int err = inode_iget(fs, inumber, &in);
   if (err < 0) return err;
@@ -242,7 +514,7 @@ static int GetDirEntries(struct unixfilesystem *fs, int inumber, struct direntv6
     int bytesLeft, numEntriesInBlock, i;
     bytesLeft = file_getblock(fs, inumber,bno,dir);
     if (bytesLeft < 0) {
-      fprintf(stderr, "Error reading directory\n");
+      *readError = 1;
       return -1;
     }
     numEntriesInBlock = bytesLeft/sizeof(struct direntv6); 
@@ -262,5 +534,6 @@ static void PrintUsageAndExit(char *progname) {
   fprintf(stderr, "-q     don't print extra info\n"); 
   fprintf(stderr, "-i     print all inode checksums\n"); 
   fprintf(stderr, "-p     print all pathname checksums\n");  
+  fprintf(stderr, "-j N   compute the checksums on N threads\n");
   exit(EXIT_FAILURE);
 }
@@ -1,31 +1,91 @@
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <string.h>
 
 #include "diskimg.h"
 
+// Only images open with a descriptor below this can be mapped.
+#define DISKIMG_MAX_MAPPED_FD 1024
+
+// Images mapped with diskimg_map(), indexed by file descriptor (base is NULL
+// if not mapped). Each descriptor has its own slot, so threads that map
+// different descriptors don't interfere with each other.
+static struct {
+  unsigned char *base;
+  size_t size;
+} mappings[DISKIMG_MAX_MAPPED_FD];
+
 int diskimg_open(char *pathname, int readOnly) {
   return open(pathname, readOnly ? O_RDONLY : O_RDWR);
 }
 
 int diskimg_getsize(int fd) {
-  return lseek(fd, 0, SEEK_END);
+  struct stat st;
+  if (fstat(fd, &st) < 0) return -1;
+  return st.st_size;
+}
+
+int diskimg_map(int fd) {
+  if (fd < 0 || fd >= DISKIMG_MAX_MAPPED_FD) return -1;
+  if (mappings[fd].base != NULL) return 0;
+
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size <= 0) return -1;
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) return -1;
+
+  mappings[fd].base = base;
+  mappings[fd].size = st.st_size;
+  return 0;
+}
+
+const void *diskimg_getsector_ptr(int fd, int sectorNum) {
+  if (fd < 0 || fd >= DISKIMG_MAX_MAPPED_FD || mappings[fd].base == NULL) return NULL;
+  if (sectorNum < 0) return NULL;
+  size_t offset = (size_t) sectorNum * DISKIMG_SECTOR_SIZE;
+  if (offset + DISKIMG_SECTOR_SIZE > mappings[fd].size) return NULL;
+  return mappings[fd].base + offset;
 }
 
 int diskimg_readsector(int fd, int sectorNum,  void *buf) {
-  if (lseek(fd, sectorNum * DISKIMG_SECTOR_SIZE, SEEK_SET) == (off_t) -1) return -1;  
-  return read(fd, buf, DISKIMG_SECTOR_SIZE);
+  const void *sector = diskimg_getsector_ptr(fd, sectorNum);
+  if (sector != NULL) {
+    memcpy(buf, sector, DISKIMG_SECTOR_SIZE);
+    return DISKIMG_SECTOR_SIZE;
+  }
+  return pread(fd, buf, DISKIMG_SECTOR_SIZE, (off_t) sectorNum * DISKIMG_SECTOR_SIZE);
 }
 
-int diskimg_writesector(int fd, int sectorNum,  void *buf) {
-  if (lseek(fd, sectorNum * DISKIMG_SECTOR_SIZE, SEEK_SET) == (off_t) -1) {
-    return -1;
+int diskimg_readsectors(int fd, int sectorNum, int count, void *buf) {
+  size_t total = (size_t) count * DISKIMG_SECTOR_SIZE;
+  const void *first = diskimg_getsector_ptr(fd, sectorNum);
+  if (first != NULL && diskimg_getsector_ptr(fd, sectorNum + count - 1) != NULL) {
+    memcpy(buf, first, total);
+    return total;
+  }
+  off_t start = (off_t) sectorNum * DISKIMG_SECTOR_SIZE;
+  size_t done = 0;
+  while (done < total) {
+    ssize_t n = pread(fd, (char *) buf + done, total - done, start + done);
+    if (n < 0) return -1;
+    if (n == 0) break;
+    done += n;
   }
+  return done;
+}
 
-  return write(fd, buf, DISKIMG_SECTOR_SIZE);
+int diskimg_writesector(int fd, int sectorNum,  void *buf) {
+  return pwrite(fd, buf, DISKIMG_SECTOR_SIZE, (off_t) sectorNum * DISKIMG_SECTOR_SIZE);
 }
 
 int diskimg_close(int fd) {
+  if (fd >= 0 && fd < DISKIMG_MAX_MAPPED_FD && mappings[fd].base != NULL) {
+    munmap(mappings[fd].base, mappings[fd].size);
+    mappings[fd].base = NULL;
+    mappings[fd].size = 0;
+  }
   return close(fd);
 }
@@ -6,6 +6,14 @@
 // Size of a disk sector (e.g. block) in bytes.
 #define DISKIMG_SECTOR_SIZE 512
 
+/**
+ * All the I/O is positioned (pread/pwrite): the file offset of the
+ * descriptor is never used, so several threads may read and write sectors
+ * of the same open image at the same time.  diskimg_map() and
+ * diskimg_close() must not run concurrently with other calls on the same
+ * descriptor.
+ */
+
 /**
  * Opens a disk image for I/O. Returns an open file descriptor, or -1 if
  * unsuccessful.  
@@ -23,6 +31,13 @@ int diskimg_getsize(int fd);
  */
 int diskimg_readsector(int fd, int sectorNum, void *buf); 
 
+/**
+ * Reads count consecutive sectors starting at sectorNum with a single large
+ * read.  Returns the number of bytes read (less than count sectors only if
+ * the image ends before), or -1 on error.
+ */
+int diskimg_readsectors(int fd, int sectorNum, int count, void *buf);
+
 /**
  * Writes the specified sector from the disk.  Returns the number of bytes
  * written, or -1 on error.
@@ -30,8 +45,24 @@ int diskimg_readsector(int fd, int sectorNum, void *buf);
 int diskimg_writesector(int fd, int sectorNum, void *buf); 
 
 /**
- * Clean up from a previous diskimg_open() call.  Returns 0 on success, or -1 on
- * error.
+ * Maps the whole disk image open as fd into memory, read-only. From then on
+ * diskimg_readsector() copies from the mapping instead of doing I/O, and
+ * diskimg_getsector_ptr() can be used.  Returns 0 on success, or -1 on
+ * error (the image is still usable through diskimg_readsector()).
+ */
+int diskimg_map(int fd);
+
+/**
+ * Returns a pointer to the specified sector inside the mapping of a disk image
+ * mapped with diskimg_map(), or NULL if the image is not mapped or the sector
+ * lies (even partially) beyond its end.  The sector must not be written
+ * through the pointer, which stays valid until diskimg_close().
+ */
+const void *diskimg_getsector_ptr(int fd, int sectorNum);
+
+/**
+ * Clean up from a previous diskimg_open() call (unmapping the image if it was
+ * mapped).  Returns 0 on success, or -1 on error.
  */
 int diskimg_close(int fd);
 
@@ -27,19 +27,20 @@ int file_getblock(struct unixfilesystem *fs,
         return -1;
     }
 
-    /* 2) Traer el inode */
-    struct inode in;
-    if (inode_iget(fs, inumber, &in) < 0) {
+    /* 2) Traer el inode (de la tabla en memoria, sin copiarlo) */
+    struct inode scratch;
+    const struct inode *in = inode_iget_ptr(fs, inumber, &scratch);
+    if (in == NULL) {
         return -1;
     }
 
     /* 3) Verificar que el inode esté asignado */
-    if ((in.i_mode & IALLOC) == 0) {
+    if ((in->i_mode & IALLOC) == 0) {
         return -1;
     }
 
     /* 4) Traducir bloque lógico a bloque físico */
-    int phys_block = inode_indexlookup(fs, &in, blockNum);
+    int phys_block = inode_indexlookup(fs, in, blockNum);
     if (phys_block < 0) {
         /* Bloque fuera de rango o no existe */
         return -1;
@@ -49,14 +50,18 @@ int file_getblock(struct unixfilesystem *fs,
         return 0;
     }
 
-    /* 5) Leer el sector completo en buffer temporal */
+    /* 5) Usar el sector de la imagen mapeada o leerlo completo en buffer temporal */
     unsigned char tmp[DISKIMG_SECTOR_SIZE];
-    if (diskimg_readsector(fs->dfd, phys_block, tmp) < 0) {
-        return -1;
+    const unsigned char *data = unixfilesystem_getsector_ptr(fs, phys_block);
+    if (data == NULL) {
+        if (unixfilesystem_readsector(fs, phys_block, tmp) < 0) {
+            return -1;
+        }
+        data = tmp;
     }
 
     /* 6) Calcular cuántos bytes del bloque son reales según el tamaño del archivo */
-    int filesize = inode_getsize(&in);
+    int filesize = inode_getsize(in);
     int offset   = blockNum * DISKIMG_SECTOR_SIZE;
 
     if (offset >= filesize) {
@@ -70,7 +75,170 @@ int file_getblock(struct unixfilesystem *fs,
                          : DISKIMG_SECTOR_SIZE);
 
     /* 7) Copiar al buffer de usuario */
-    memcpy(buf, tmp, to_copy);
+    memcpy(buf, data, to_copy);
 
     return to_copy;
 }
+
+struct filehandle {
+  struct unixfilesystem *fs;
+  int size;           // tamaño del archivo en bytes
+  int nblocks;        // bloques lógicos que ocupa
+  uint16_t *blocks;   // bloque físico de cada bloque lógico (0 si no existe)
+  int offset;         // posición de lectura
+};
+
+/**
+ * file_open:
+ *   - fs: sistema de archivos abierto
+ *   - inumber: número de inode (>= 1)
+ *
+ * Trae el inode y resuelve de una vez su mapa de bloques, así las lecturas
+ * no vuelven a recorrer los bloques indirectos por cada bloque.
+ * Devuelve el archivo abierto o NULL en caso de error.
+ */
+struct filehandle *file_open(struct unixfilesystem *fs, int inumber)
+{
+    if (fs == NULL || inumber < 1) {
+        return NULL;
+    }
+
+    struct inode scratch;
+    const struct inode *in = inode_iget_ptr(fs, inumber, &scratch);
+    if (in == NULL || (in->i_mode & IALLOC) == 0) {
+        return NULL;
+    }
+
+    struct filehandle *f = malloc(sizeof(struct filehandle));
+    if (f == NULL) {
+        return NULL;
+    }
+    f->fs      = fs;
+    f->size    = inode_getsize(in);
+    f->nblocks = (f->size + DISKIMG_SECTOR_SIZE - 1) / DISKIMG_SECTOR_SIZE;
+    f->offset  = 0;
+    f->blocks  = malloc((f->nblocks > 0 ? f->nblocks : 1) * sizeof(uint16_t));
+    if (f->blocks == NULL || inode_getblockmap(fs, in, f->blocks, f->nblocks) < 0) {
+        file_close(f);
+        return NULL;
+    }
+    return f;
+}
+
+/**
+ * file_read:
+ *   - f: archivo abierto con file_open
+ *   - buf: destino (tamaño ≥ len)
+ *   - len: cantidad máxima de bytes a leer
+ *
+ * Copia desde la posición actual usando el mapa de bloques ya resuelto. Los
+ * bloques enteros que siguen contiguos en disco se leen juntos, con una sola
+ * lectura grande directo a buf; los bloques parciales (el primero, el último)
+ * pasan por la caché de sectores. Un bloque inexistente dentro del tamaño
+ * del archivo es un error, igual que en file_getblock.
+ * Devuelve los bytes leídos (0 al final del archivo) o -1 en caso de error.
+ */
+int file_read(struct filehandle *f, void *buf, int len)
+{
+    if (f == NULL || buf == NULL || len < 0) {
+        return -1;
+    }
+
+    unsigned char *out = buf;
+    int total = 0;
+    while (total < len && f->offset < f->size) {
+        int bno    = f->offset / DISKIMG_SECTOR_SIZE;
+        int within = f->offset % DISKIMG_SECTOR_SIZE;
+        int phys   = f->blocks[bno];
+        if (phys == 0) {
+            return -1;
+        }
+
+        /* Bloques enteros: juntar los que siguen contiguos en disco */
+        int wholeBlocks = 0;
+        if (within == 0) {
+            int left = (f->size - f->offset < len - total) ? f->size - f->offset : len - total;
+            wholeBlocks = left / DISKIMG_SECTOR_SIZE;
+        }
+        if (wholeBlocks > 1) {
+            int run = 1;
+            while (run < wholeBlocks && f->blocks[bno + run] == phys + run) {
+                run++;
+            }
+            if (run > 1) {
+                int bytes = run * DISKIMG_SECTOR_SIZE;
+                if (unixfilesystem_readsectors(f->fs, phys, run, out + total) != bytes) {
+                    return -1;
+                }
+                total     += bytes;
+                f->offset += bytes;
+                continue;
+            }
+        }
+
+        /* Bytes de este bloque que quedan en el archivo y caben en buf */
+        int chunk = DISKIMG_SECTOR_SIZE - within;
+        if (chunk > f->size - f->offset) chunk = f->size - f->offset;
+        if (chunk > len - total) chunk = len - total;
+
+        const unsigned char *data = unixfilesystem_getsector_ptr(f->fs, phys);
+        unsigned char tmp[DISKIMG_SECTOR_SIZE];
+        if (data == NULL) {
+            /* Un bloque entero va directo a buf; si no, por un buffer temporal */
+            unsigned char *dst = (within == 0 && chunk == DISKIMG_SECTOR_SIZE) ? out + total : tmp;
+            if (unixfilesystem_readsector(f->fs, phys, dst) < 0) {
+                return -1;
+            }
+            data = dst;
+        }
+        if (data != out + total) {
+            memcpy(out + total, data + within, chunk);
+        }
+
+        total     += chunk;
+        f->offset += chunk;
+    }
+    return total;
+}
+
+/**
+ * file_read_range:
+ *   - fs: sistema de archivos abierto
+ *   - inumber: número de inode (>= 1)
+ *   - offset: byte del archivo desde donde leer (>= 0)
+ *   - len: cantidad máxima de bytes a leer (>= 0)
+ *   - buf: destino (tamaño ≥ len)
+ *
+ * Abre el archivo, se posiciona en offset y lee con file_read, que junta
+ * los bloques contiguos en disco en lecturas grandes.
+ * Devuelve los bytes leídos (0 si offset está al final o más allá) o -1 en
+ * caso de error.
+ */
+int file_read_range(struct unixfilesystem *fs, int inumber, int offset, int len, void *buf)
+{
+    if (offset < 0 || len < 0 || buf == NULL) {
+        return -1;
+    }
+    struct filehandle *f = file_open(fs, inumber);
+    if (f == NULL) {
+        return -1;
+    }
+    f->offset = (offset < f->size) ? offset : f->size;
+    int bytes = file_read(f, buf, len);
+    file_close(f);
+    return bytes;
+}
+
+int file_size(const struct filehandle *f)
+{
+    return f->size;
+}
+
+void file_close(struct filehandle *f)
+{
+    if (f == NULL) {
+        return;
+    }
+    free(f->blocks);
+    free(f);
+}
@@ -9,4 +9,40 @@
  */
 int file_getblock(struct unixfilesystem *fs, int inumber, int blockNo, void *buf); 
 
+/**
+ * An open file: its size and block map, resolved once by file_open(), and
+ * the current read position.
+ */
+struct filehandle;
+
+/**
+ * Opens the file with the specified inumber for sequential reading.  Returns
+ * NULL on error (e.g. the inode is not allocated).
+ */
+struct filehandle *file_open(struct unixfilesystem *fs, int inumber);
+
+/**
+ * Reads up to len bytes from the current position into buf and advances it.
+ * Returns the number of bytes read (0 at the end of the file), -1 on error.
+ */
+int file_read(struct filehandle *f, void *buf, int len);
+
+/**
+ * Reads up to len bytes starting at byte offset of the file with the
+ * specified inumber into buf.  Runs of blocks that are contiguous on disk
+ * are read with a single large read.  Returns the number of bytes read (0 if
+ * offset is at or past the end of the file), -1 on error.
+ */
+int file_read_range(struct unixfilesystem *fs, int inumber, int offset, int len, void *buf);
+
+/**
+ * Returns the size in bytes of an open file.
+ */
+int file_size(const struct filehandle *f);
+
+/**
+ * Releases a file opened with file_open().  NULL is ignored.
+ */
+void file_close(struct filehandle *f);
+
 #endif // _FILE_H_
@@ -26,22 +26,72 @@ int inode_iget(struct unixfilesystem *fs,
         return -1;
     }
 
+    /* Si está en la tabla cargada al montar, copiarlo de ahí */
+    if (inumber <= fs->ninodes) {
+        *inp = fs->inodes[inumber - 1];
+        return 0;
+    }
+
     /* Calcular sector que contiene el inode */
     int sector = INODE_START_SECTOR + (inumber - 1) / INODES_PER_SECTOR;
     struct inode inodes[INODES_PER_SECTOR];
 
-    /* Leer todos los inodes de ese sector */
-    if (diskimg_readsector(fs->dfd, sector, inodes) < 0) {
-        return -1;
+    /* Usar el sector de la imagen mapeada o leer todos los inodes de ese sector */
+    const struct inode *sectorInodes = unixfilesystem_getsector_ptr(fs, sector);
+    if (sectorInodes == NULL) {
+        if (unixfilesystem_readsector(fs, sector, inodes) < 0) {
+            return -1;
+        }
+        sectorInodes = inodes;
     }
 
     /* Calcular índice dentro del sector y copiar al destino */
     int index = (inumber - 1) % INODES_PER_SECTOR;
-    *inp = inodes[index];
+    *inp = sectorInodes[index];
 
     return 0;
 }
 
+/**
+ * inode_iget_ptr:
+ *   - fs:      sistema de archivos abierto
+ *   - inumber: número de inode (>= 1)
+ *   - scratch: dónde leerlo si no está en la tabla de inodes
+ *
+ * Devuelve un puntero al inode en la tabla en memoria (sin copiarlo), o a
+ * scratch si hubo que leerlo del disco. NULL en caso de error.
+ */
+const struct inode *inode_iget_ptr(struct unixfilesystem *fs,
+                                   int inumber,
+                                   struct inode *scratch)
+{
+    if (fs == NULL || inumber < 1) {
+        return NULL;
+    }
+    if (inumber <= fs->ninodes) {
+        return &fs->inodes[inumber - 1];
+    }
+    return inode_iget(fs, inumber, scratch) < 0 ? NULL : scratch;
+}
+
+/**
+ * Devuelve la entrada index del bloque de punteros que está en sector
+ * (leyéndola directamente de la imagen si está mapeada), o -1 si no se
+ * pudo leer el bloque.
+ */
+static int indirect_entry(struct unixfilesystem *fs, int sector, int index)
+{
+    uint16_t copy[BLOCKS_PER_INDIRECT];
+    const uint16_t *block = unixfilesystem_getsector_ptr(fs, sector);
+    if (block == NULL) {
+        if (unixfilesystem_readsector(fs, sector, copy) < 0) {
+            return -1;
+        }
+        block = copy;
+    }
+    return block[index];
+}
+
 /**
  * inode_indexlookup:
  *   - fs:      sistema de archivos abierto
@@ -58,7 +108,7 @@ int inode_iget(struct unixfilesystem *fs,
  *   - -1 en caso de error o rango inválido
  */
 int inode_indexlookup(struct unixfilesystem *fs,
-                      struct inode *inp,
+                      const struct inode *inp,
                       int blockNum)
 {
     /* Validaciones básicas */
@@ -85,13 +135,8 @@ int inode_indexlookup(struct unixfilesystem *fs,
             return -1;
         }
 
-        uint16_t indir_block[BLOCKS_PER_INDIRECT];
-        if (diskimg_readsector(fs->dfd, indir_sector, indir_block) < 0) {
-            return -1;
-        }
-
-        int data_block = indir_block[entry_offset];
-        return (data_block == 0) ? -1 : data_block;
+        int data_block = indirect_entry(fs, indir_sector, entry_offset);
+        return (data_block <= 0) ? -1 : data_block;
     }
 
     /* 3) Doble indirecto para bloques más allá */
@@ -111,29 +156,101 @@ int inode_indexlookup(struct unixfilesystem *fs,
         return -1;
     }
 
-    uint16_t outer_block[BLOCKS_PER_INDIRECT];
-    if (diskimg_readsector(fs->dfd, double_indir_sector, outer_block) < 0) {
+    /* Obtener sector intermedio */
+    int indir_sector = indirect_entry(fs, double_indir_sector, outer_index);
+    if (indir_sector <= 0) {
         return -1;
     }
 
-    /* Obtener sector intermedio */
-    int indir_sector = outer_block[outer_index];
-    if (indir_sector == 0) {
-        return -1;
+    /* Leer bloque de punteros internos y devolver bloque de datos */
+    int data_block = indirect_entry(fs, indir_sector, inner_index);
+    return (data_block <= 0) ? -1 : data_block;
+}
+
+/**
+ * Copia a blocks[] las entradas [first, first + count) del bloque de punteros
+ * que está en sector (todas en 0 si sector es 0). Devuelve 0 o -1 si no se
+ * pudo leer el bloque.
+ */
+static int copy_indirect(struct unixfilesystem *fs, int sector, int first, int count, uint16_t *blocks)
+{
+    if (sector == 0) {
+        memset(blocks, 0, count * sizeof(uint16_t));
+        return 0;
+    }
+    uint16_t copy[BLOCKS_PER_INDIRECT];
+    const uint16_t *block = unixfilesystem_getsector_ptr(fs, sector);
+    if (block == NULL) {
+        if (unixfilesystem_readsector(fs, sector, copy) < 0) {
+            return -1;
+        }
+        block = copy;
     }
+    memcpy(blocks, block + first, count * sizeof(uint16_t));
+    return 0;
+}
 
-    /* Leer bloque de punteros internos */
-    uint16_t inner_block[BLOCKS_PER_INDIRECT];
-    if (diskimg_readsector(fs->dfd, indir_sector, inner_block) < 0) {
+/**
+ * inode_getblockmap:
+ *   - fs:      sistema de archivos abierto
+ *   - inp:     puntero al inode ya cargado
+ *   - blocks:  salida, un número de bloque físico por bloque lógico
+ *   - nblocks: cantidad de bloques lógicos a resolver (>= 0)
+ *
+ * Igual que llamar a inode_indexlookup para cada bloque (con 0 donde no hay
+ * bloque), pero leyendo cada bloque de punteros una sola vez.
+ * Devuelve 0 si tiene éxito o -1 en caso de error.
+ */
+int inode_getblockmap(struct unixfilesystem *fs,
+                      const struct inode *inp,
+                      uint16_t *blocks,
+                      int nblocks)
+{
+    if (fs == NULL || inp == NULL || blocks == NULL || nblocks < 0) {
         return -1;
     }
 
-    /* Devolver bloque de datos */
-    int data_block = inner_block[inner_index];
-    return (data_block == 0) ? -1 : data_block;
+    /* 1) Archivos pequeños: bloques directos */
+    if ((inp->i_mode & ILARG) == 0) {
+        for (int b = 0; b < nblocks; b++) {
+            blocks[b] = (b < 8) ? inp->i_addr[b] : 0;
+        }
+        return 0;
+    }
+
+    /* 2) Indirección simple: un bloque de punteros por cada 256 bloques */
+    int b = 0;
+    for (int k = 0; k < 7 && b < nblocks; k++) {
+        int count = nblocks - b < BLOCKS_PER_INDIRECT ? nblocks - b : BLOCKS_PER_INDIRECT;
+        if (copy_indirect(fs, inp->i_addr[k], 0, count, blocks + b) < 0) {
+            return -1;
+        }
+        b += count;
+    }
+    if (b == nblocks) {
+        return 0;
+    }
+
+    /* 3) Doble indirecto: el bloque externo da los bloques de punteros internos */
+    uint16_t outer[BLOCKS_PER_INDIRECT];
+    if (copy_indirect(fs, inp->i_addr[7], 0, BLOCKS_PER_INDIRECT, outer) < 0) {
+        return -1;
+    }
+    for (int k = 0; k < BLOCKS_PER_INDIRECT && b < nblocks; k++) {
+        int count = nblocks - b < BLOCKS_PER_INDIRECT ? nblocks - b : BLOCKS_PER_INDIRECT;
+        if (copy_indirect(fs, outer[k], 0, count, blocks + b) < 0) {
+            return -1;
+        }
+        b += count;
+    }
+    /* Más allá del doble indirecto no hay bloques */
+    if (b < nblocks) {
+        memset(blocks + b, 0, (nblocks - b) * sizeof(uint16_t));
+    }
+    return 0;
 }
 
-int inode_getsize(struct inode *inp)
+int inode_getsize(const struct inode *inp)
 {
     return ((inp->i_size0 << 16) | inp->i_size1);
 }
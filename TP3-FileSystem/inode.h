@@ -9,17 +9,32 @@
  */
 int inode_iget(struct unixfilesystem *fs, int inumber, struct inode *inp); 
 
+/**
+ * Fast path of inode_iget(): returns a pointer to the specified inode in the
+ * filesystem's in-memory inode table, without copying it.  If the inode is
+ * not in the table it is read into *scratch and scratch is returned.  Returns
+ * NULL on error.  The pointer is valid until the filesystem is freed.
+ */
+const struct inode *inode_iget_ptr(struct unixfilesystem *fs, int inumber, struct inode *scratch);
+
 /**
  * Given an index of a file block, retrieves the file's actual block number
  * of from the given inode.
  *
  * Returns the disk block number on success, -1 on error.  
  */
-int inode_indexlookup(struct unixfilesystem *fs, struct inode *inp, int blockNum);
+int inode_indexlookup(struct unixfilesystem *fs, const struct inode *inp, int blockNum);
+
+/**
+ * Resolves the disk block numbers of the first nblocks blocks of the file
+ * into blocks[], reading each indirect block only once.  Blocks that don't
+ * exist are stored as 0.  Returns 0 on success, -1 on error.
+ */
+int inode_getblockmap(struct unixfilesystem *fs, const struct inode *inp, uint16_t *blocks, int nblocks);
 
 /**
  * Computes the size in bytes of the file identified by the given inode
  */
-int inode_getsize(struct inode *inp);
+int inode_getsize(const struct inode *inp);
 
 #endif // _INODE_
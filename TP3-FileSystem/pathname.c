@@ -35,14 +35,15 @@ int pathname_lookup(struct unixfilesystem *fs, const char *pathname)
         return ROOT_INUMBER;
     }
 
-    /* 4) Copiar el pathname porque strtok lo modifica */
+    /* 4) Copiar el pathname porque strtok_r lo modifica */
     char pathcopy[MAX_PATH_LEN];
     strncpy(pathcopy, pathname, sizeof(pathcopy));
     pathcopy[sizeof(pathcopy) - 1] = '\0';
 
     /* 5) Iniciar búsqueda desde la raíz */
     int current_inumber = ROOT_INUMBER;
-    char *token = strtok(pathcopy, "/");
+    char *saveptr;  /* strtok_r: sin estado global, se puede llamar desde varios hilos */
+    char *token = strtok_r(pathcopy, "/", &saveptr);
 
     /* 6) Iterar por cada componente */
     while (token != NULL) {
@@ -59,7 +60,7 @@ int pathname_lookup(struct unixfilesystem *fs, const char *pathname)
 
         /* 8) Avanzar al siguiente nivel */
         current_inumber = entry.d_inumber;
-        token = strtok(NULL, "/");
+        token = strtok_r(NULL, "/", &saveptr);
     }
 
     /* 9) Devolver el inode resultante */
@@ -0,0 +1,191 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "sectorcache.h"
+#include "diskimg.h"
+
+/**
+ * Cada sector cacheado vive en una entrada que está a la vez en una lista
+ * doblemente enlazada ordenada por uso (el más reciente al frente) y en la
+ * cadena de su bucket de la tabla hash, indexada por número de sector.
+ */
+struct cacheentry {
+  int sector;                       // sector guardado
+  struct cacheentry *prev, *next;   // lista LRU
+  struct cacheentry *hnext;         // siguiente en el mismo bucket
+  unsigned char data[DISKIMG_SECTOR_SIZE];
+};
+
+struct sectorcache {
+  int capacity;
+  int used;                         // entradas de entries[] usadas alguna vez
+  struct cacheentry *entries;
+  struct cacheentry **buckets;
+  unsigned int bucketMask;          // cantidad de buckets - 1 (potencia de 2)
+  struct cacheentry *head, *tail;   // más y menos recientemente usada
+  uint64_t hits, misses;
+  pthread_mutex_t lock;             // protege todo lo anterior (salvo capacity)
+};
+
+struct sectorcache *sectorcache_create(int capacity)
+{
+    if (capacity < 1) {
+        return NULL;
+    }
+
+    struct sectorcache *cache = calloc(1, sizeof(struct sectorcache));
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    /* Al menos dos buckets por entrada para que las cadenas sean cortas */
+    unsigned int nbuckets = 1;
+    while (nbuckets < 2 * (unsigned int)capacity) {
+        nbuckets <<= 1;
+    }
+
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->capacity   = capacity;
+    cache->bucketMask = nbuckets - 1;
+    cache->entries    = malloc(capacity * sizeof(struct cacheentry));
+    cache->buckets    = calloc(nbuckets, sizeof(struct cacheentry *));
+    if (cache->entries == NULL || cache->buckets == NULL) {
+        sectorcache_destroy(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void sectorcache_destroy(struct sectorcache *cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache);
+}
+
+static struct cacheentry **bucket_of(struct sectorcache *cache, int sector)
+{
+    /* Hash multiplicativo: sectores consecutivos caen en buckets distintos */
+    unsigned int h = (unsigned int)sector * 2654435761u;
+    return &cache->buckets[(h >> 16 ^ h) & cache->bucketMask];
+}
+
+static struct cacheentry *lookup(struct sectorcache *cache, int sector)
+{
+    struct cacheentry *e = *bucket_of(cache, sector);
+    while (e != NULL && e->sector != sector) {
+        e = e->hnext;
+    }
+    return e;
+}
+
+static void lru_unlink(struct sectorcache *cache, struct cacheentry *e)
+{
+    if (e->prev) e->prev->next = e->next; else cache->head = e->next;
+    if (e->next) e->next->prev = e->prev; else cache->tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void lru_push_front(struct sectorcache *cache, struct cacheentry *e)
+{
+    e->prev = NULL;
+    e->next = cache->head;
+    if (cache->head) cache->head->prev = e; else cache->tail = e;
+    cache->head = e;
+}
+
+static void hash_remove(struct sectorcache *cache, struct cacheentry *e)
+{
+    struct cacheentry **link = bucket_of(cache, e->sector);
+    while (*link != e) {
+        link = &(*link)->hnext;
+    }
+    *link = e->hnext;
+    e->hnext = NULL;
+}
+
+/**
+ * sectorcache_readsector:
+ *   - cache:     caché del sistema de archivos
+ *   - fd:        descriptor de la imagen (de diskimg_open)
+ *   - sectorNum: sector a leer
+ *   - buf:       destino (tamaño ≥ DISKIMG_SECTOR_SIZE)
+ *
+ * Si el sector está cacheado lo copia y lo marca como el más reciente. Si
+ * no, lo lee del disco directo a buf (sin tener tomado el lock, así los demás
+ * hilos siguen usando la caché) y después lo guarda en la entrada libre o
+ * menos usada. Las lecturas fallidas o incompletas no quedan en la caché.
+ */
+int sectorcache_readsector(struct sectorcache *cache, int fd, int sectorNum, void *buf)
+{
+    if (cache == NULL || buf == NULL || sectorNum < 0) {
+        return -1;
+    }
+
+    /* 1) Buscar en la tabla hash */
+    pthread_mutex_lock(&cache->lock);
+    struct cacheentry *e = lookup(cache, sectorNum);
+    if (e != NULL) {
+        cache->hits++;
+        if (e != cache->head) {
+            lru_unlink(cache, e);
+            lru_push_front(cache, e);
+        }
+        memcpy(buf, e->data, DISKIMG_SECTOR_SIZE);
+        pthread_mutex_unlock(&cache->lock);
+        return DISKIMG_SECTOR_SIZE;
+    }
+    cache->misses++;
+    pthread_mutex_unlock(&cache->lock);
+
+    /* 2) Fallo: leer del disco sin el lock */
+    int bytes = diskimg_readsector(fd, sectorNum, buf);
+    if (bytes != DISKIMG_SECTOR_SIZE) {
+        return bytes;
+    }
+
+    /* 3) Guardarlo, salvo que otro hilo lo haya hecho mientras tanto */
+    pthread_mutex_lock(&cache->lock);
+    if (lookup(cache, sectorNum) == NULL) {
+        if (cache->used < cache->capacity) {
+            e = &cache->entries[cache->used++];
+        } else {
+            e = cache->tail;
+            lru_unlink(cache, e);
+            hash_remove(cache, e);
+        }
+        e->sector = sectorNum;
+        memcpy(e->data, buf, DISKIMG_SECTOR_SIZE);
+        struct cacheentry **bucket = bucket_of(cache, sectorNum);
+        e->hnext = *bucket;
+        *bucket = e;
+        lru_push_front(cache, e);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return DISKIMG_SECTOR_SIZE;
+}
+
+int sectorcache_capacity(const struct sectorcache *cache)
+{
+    return cache->capacity;
+}
+
+uint64_t sectorcache_hits(struct sectorcache *cache)
+{
+    pthread_mutex_lock(&cache->lock);
+    uint64_t hits = cache->hits;
+    pthread_mutex_unlock(&cache->lock);
+    return hits;
+}
+
+uint64_t sectorcache_misses(struct sectorcache *cache)
+{
+    pthread_mutex_lock(&cache->lock);
+    uint64_t misses = cache->misses;
+    pthread_mutex_unlock(&cache->lock);
+    return misses;
+}
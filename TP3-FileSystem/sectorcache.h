@@ -0,0 +1,45 @@
+#ifndef _SECTORCACHE_H_
+#define _SECTORCACHE_H_
+
+#include <stdint.h>
+
+/**
+ * LRU cache of disk image sectors. Once full, reading a sector that is not
+ * cached evicts the least recently used one. The cache assumes that the
+ * image is not written while it is in use. Reads may be served to several
+ * threads at the same time; a mutex protects the cache, and it is not held
+ * while reading from the disk.
+ */
+struct sectorcache;
+
+/**
+ * Creates a cache that holds up to capacity sectors. Returns NULL if
+ * capacity < 1 or out of memory.
+ */
+struct sectorcache *sectorcache_create(int capacity);
+
+/**
+ * Frees a cache created by sectorcache_create(). NULL is ignored. No other
+ * thread may be using the cache.
+ */
+void sectorcache_destroy(struct sectorcache *cache);
+
+/**
+ * Same as diskimg_readsector(fd, sectorNum, buf), but served from the cache
+ * when possible. Returns the number of bytes read, or -1 on error.
+ */
+int sectorcache_readsector(struct sectorcache *cache, int fd, int sectorNum, void *buf);
+
+/**
+ * Returns the number of sectors the cache can hold.
+ */
+int sectorcache_capacity(const struct sectorcache *cache);
+
+/**
+ * Number of reads served from the cache (hits) and from the disk (misses)
+ * since the cache was created.
+ */
+uint64_t sectorcache_hits(struct sectorcache *cache);
+uint64_t sectorcache_misses(struct sectorcache *cache);
+
+#endif // _SECTORCACHE_H_
@@ -2,12 +2,39 @@
 #include <stdlib.h>
 #include "unixfilesystem.h"
 #include "diskimg.h" 
+#include "sectorcache.h"
+#include "dirindex.h"
 
 /**
- * Allocates and initializes a struct unixfilesystem given a filedescriptor to 
- * an open disk image. 
- * Return NULL on error. 
+ * Loads the inode table (the s_isize sectors after the superblock) into
+ * fs->inodes: in place if the image is mapped, otherwise with one large read.
+ * If the image ends early only the inodes that could be read are loaded; the
+ * rest are read sector by sector, as without a table.
  */
+static void loadinodes(struct unixfilesystem *fs) {
+  int nsectors = fs->superblock.s_isize;
+  int perSector = DISKIMG_SECTOR_SIZE / sizeof(struct inode);
+  if (nsectors == 0) return;
+
+  const void *mapped = diskimg_getsector_ptr(fs->dfd, INODE_START_SECTOR);
+  if (mapped != NULL && diskimg_getsector_ptr(fs->dfd, INODE_START_SECTOR + nsectors - 1) != NULL) {
+    fs->inodes = mapped;
+    fs->ninodes = nsectors * perSector;
+    return;
+  }
+
+  struct inode *table = malloc((size_t) nsectors * DISKIMG_SECTOR_SIZE);
+  if (table == NULL) return;
+  int bytes = diskimg_readsectors(fs->dfd, INODE_START_SECTOR, nsectors, table);
+  int sectorsRead = bytes < 0 ? 0 : bytes / DISKIMG_SECTOR_SIZE;
+  if (sectorsRead == 0) {
+    free(table);
+    return;
+  }
+  fs->inodes = fs->inodeCopy = table;
+  fs->ninodes = sectorsRead * perSector;
+}
+
 
 struct unixfilesystem *unixfilesystem_init(int dfd) {
   // Validate the bootblock.  This will catch the situation where something 
@@ -35,11 +62,63 @@ struct unixfilesystem *unixfilesystem_init(int dfd) {
   }
 
   fs->dfd = dfd;  
+  fs->cache = NULL;
+  fs->inodes = NULL;
+  fs->ninodes = 0;
+  fs->inodeCopy = NULL;
+  fs->dirs = NULL;
   if (diskimg_readsector(dfd, SUPERBLOCK_SECTOR, &fs->superblock) != DISKIMG_SECTOR_SIZE) {
     fprintf(stderr, "Error reading superblock\n");
     free(fs);
     return NULL;
   }
 
+  // Without memory for the cache the filesystem still works, uncached.
+  fs->cache = sectorcache_create(UNIXFILESYSTEM_CACHE_SECTORS);
+  // Likewise without the directory indexes: lookups scan the directories.
+  fs->dirs = dirindexcache_create();
+
+  loadinodes(fs);
+
   return fs;
 }
+
+void unixfilesystem_free(struct unixfilesystem *fs) {
+  if (fs == NULL) return;
+  sectorcache_destroy(fs->cache);
+  dirindexcache_destroy(fs->dirs);
+  free(fs->inodeCopy);
+  free(fs);
+}
+
+int unixfilesystem_readsectors(struct unixfilesystem *fs, int sectorNum, int count, void *buf) {
+  return diskimg_readsectors(fs->dfd, sectorNum, count, buf);
+}
+
+const void *unixfilesystem_getsector_ptr(struct unixfilesystem *fs, int sectorNum) {
+  return diskimg_getsector_ptr(fs->dfd, sectorNum);
+}
+
+int unixfilesystem_readsector(struct unixfilesystem *fs, int sectorNum, void *buf) {
+  if (fs->cache == NULL || diskimg_getsector_ptr(fs->dfd, sectorNum) != NULL) {
+    return diskimg_readsector(fs->dfd, sectorNum, buf);
+  }
+  return sectorcache_readsector(fs->cache, fs->dfd, sectorNum, buf);
+}
+
+int unixfilesystem_setcachesize(struct unixfilesystem *fs, int nsectors) {
+  if (nsectors < 0) return -1;
+  struct sectorcache *cache = NULL;
+  if (nsectors > 0) {
+    cache = sectorcache_create(nsectors);
+    if (cache == NULL) return -1;
+  }
+  sectorcache_destroy(fs->cache);
+  fs->cache = cache;
+  return 0;
+}
+
+void unixfilesystem_cachestats(struct unixfilesystem *fs, uint64_t *hits, uint64_t *misses) {
+  *hits = fs->cache ? sectorcache_hits(fs->cache) : 0;
+  *misses = fs->cache ? sectorcache_misses(fs->cache) : 0;
+}
@@ -25,11 +25,80 @@
 #define ROOT_INUMBER        1
 #define BOOTBLOCK_MAGIC_NUM 0407
 
+// Default number of sectors kept in the sector cache of each filesystem.
+#define UNIXFILESYSTEM_CACHE_SECTORS 1024
+
+struct sectorcache;
+struct dirindexcache;
+
+/**
+ * Concurrency: once unixfilesystem_init() returns, every read path of the
+ * library (inode_*, file_* including file handles, directory_findname,
+ * pathname_lookup and chksumfile_*) may be called from several threads at
+ * the same time on the same struct unixfilesystem.  The disk image is read
+ * with positioned I/O, the inode table is read-only, and the sector cache
+ * and the cache of directory indexes have their own locks.  A file handle
+ * must be used by one thread at a time, and unixfilesystem_setcachesize()
+ * and unixfilesystem_free() must not run concurrently with anything else on
+ * the filesystem.
+ */
 struct unixfilesystem {
   int dfd; // Handle from the diskimg module to read the diskimg.
   struct filsys superblock;  // The superblock read from the diskimage.
+  struct sectorcache *cache; // LRU cache of sectors read, NULL if disabled.
+  const struct inode *inodes; // Inode table loaded at init (inumber i at [i-1]), NULL if not loaded.
+  int ninodes;               // Number of inodes in the table.
+  struct inode *inodeCopy;   // The table when it was read into memory, NULL if it points into the mapped image.
+  struct dirindexcache *dirs; // Name indexes of the directories looked up so far, NULL if disabled.
 };
 
+/**
+ * Allocates and initializes a struct unixfilesystem given a file descriptor
+ * to an open disk image, loading its whole inode table into memory.  If the
+ * image is mapped (diskimg_map()) the table is used in place.  Returns NULL on
+ * error.
+ */
 struct unixfilesystem *unixfilesystem_init(int fd);
 
+/**
+ * Frees a struct unixfilesystem returned by unixfilesystem_init() and its
+ * cache. Does not close the disk image.
+ */
+void unixfilesystem_free(struct unixfilesystem *fs);
+
+/**
+ * Reads the specified sector of the filesystem's disk image, through its
+ * sector cache (or straight from the mapping if the image is mapped, which
+ * needs no cache). Returns the number of bytes read, or -1 on error. All the
+ * layers above diskimg read the disk through this function.
+ */
+int unixfilesystem_readsector(struct unixfilesystem *fs, int sectorNum, void *buf);
+
+/**
+ * Reads count consecutive sectors starting at sectorNum with one large read
+ * (or one copy from the mapping), bypassing the sector cache.  Returns the
+ * number of bytes read, or -1 on error.
+ */
+int unixfilesystem_readsectors(struct unixfilesystem *fs, int sectorNum, int count, void *buf);
+
+/**
+ * Returns a pointer to the specified sector when the disk image is mapped in
+ * memory (see diskimg_map()), NULL otherwise; callers then fall back to
+ * unixfilesystem_readsector().
+ */
+const void *unixfilesystem_getsector_ptr(struct unixfilesystem *fs, int sectorNum);
+
+/**
+ * Replaces the sector cache with an empty one that holds up to nsectors
+ * sectors (0 disables caching). Returns 0 on success, -1 on error.
+ */
+int unixfilesystem_setcachesize(struct unixfilesystem *fs, int nsectors);
+
+/**
+ * Returns how many sector reads were served from the cache (hits) and from
+ * the disk image (misses) since the cache was created. Both are 0 without
+ * a cache.
+ */
+void unixfilesystem_cachestats(struct unixfilesystem *fs, uint64_t *hits, uint64_t *misses);
+
 #endif // _UNIXFILESYSTEM_H_
@@ -1,6 +1,10 @@
-#include <mutex>
 #include "Semaphore.h"
-#include <condition_variable>
+#ifdef __linux__
+#include <linux/futex.h>  // for FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <sys/syscall.h>  // for SYS_futex
+#include <unistd.h>       // for syscall
+#include <ctime>          // for timespec
+#endif
 
 /**
  * @brief Constructs a Semaphore object with the specified initial count.
@@ -10,16 +14,43 @@
  *
  * @param count The initial count of the semaphore.
  */
-Semaphore::Semaphore(int count) : count_(count) {}
+Semaphore::Semaphore(int count) : state_((uint32_t)count) {}
+
+static const uint64_t kOneWaiter = (uint64_t)1 << 32;  // un hilo más esperando
+
+static uint32_t unitsOf(uint64_t state) { return (uint32_t)state; }
+
+// Toma una unidad si hay. Si el hilo estaba anotado como esperando, en la
+// misma operación deja de estarlo
+bool Semaphore::acquire(bool registered)
+{
+    uint64_t state = state_.load();
+    while (unitsOf(state) > 0) {
+        if (state_.compare_exchange_weak(state, state - 1 - (registered ? kOneWaiter : 0)))
+            return true;
+    }
+    return false;
+}
 
 /**
  * Signals the semaphore, allowing one waiting thread to proceed.
+ * Only enters the kernel if some thread may be sleeping in wait().
  */
 void Semaphore::signal () 
 {
-    lock_guard<mutex> lg(mutex_);
-    count_++;
-    if(count_ == 1) condition_.notify_all();
+    // unidades y esperas están en la misma palabra: o vemos al que va a
+    // dormir, o él ve la unidad. Después de esto no se toca state_
+    if (state_.fetch_add(1) >= kOneWaiter) wakeOne();
+}
+
+/**
+ * @brief Acquires the semaphore if it is available, without blocking.
+ *
+ * @return true if the count was positive and has been decremented, false otherwise.
+ */
+bool Semaphore::try_wait()
+{
+    return acquire(false);
 }
 
 /**
@@ -28,14 +59,94 @@ void Semaphore::signal ()
  * This function blocks the current thread until the semaphore is available.
  * Once the semaphore becomes available, it is acquired by decrementing the count.
  * 
- * @note This function assumes that the caller has already acquired the lock associated with the semaphore.
- * 
  * @param None.
  * @return None.
  */
 void Semaphore::wait() 
+{
+    if (acquire(false)) return;
+    state_.fetch_add(kOneWaiter);
+    while (!acquire(true)) sleep(nullptr);
+}
+
+
+/**
+ * @brief Like wait(), but gives up after the specified timeout.
+ *
+ * @param timeout Maximum time to block.
+ * @return true if the semaphore was acquired, false if the timeout expired.
+ */
+bool Semaphore::wait_for(chrono::milliseconds timeout)
+{
+    if (acquire(false)) return true;
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + timeout;
+    state_.fetch_add(kOneWaiter);
+    while (!acquire(true)) {
+        if (!sleep(&deadline)) {
+            state_.fetch_sub(kOneWaiter);
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef __linux__
+
+static_assert(sizeof(atomic<uint64_t>) == sizeof(uint64_t), "state_ debe ser una palabra de 64 bits");
+
+// Mitad de state_ con las unidades, que es la palabra de 32 bits del futex
+static int *unitsWord(atomic<uint64_t> *state)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return reinterpret_cast<int *>(state) + 1;
+#else
+    return reinterpret_cast<int *>(state);
+#endif
+}
+
+// Duerme mientras las unidades sigan en cero (el kernel lo verifica
+// atómicamente), hasta que lo despierten o venza deadline. Devuelve false si
+// ya venció
+bool Semaphore::sleep(const chrono::steady_clock::time_point *deadline)
+{
+    timespec ts;
+    timespec *timeout = nullptr;
+    if (deadline) {
+        chrono::steady_clock::duration left = *deadline - chrono::steady_clock::now();
+        if (left <= chrono::steady_clock::duration::zero()) return false;
+        long long ns = chrono::duration_cast<chrono::nanoseconds>(left).count();
+        ts.tv_sec = (time_t)(ns / 1000000000);
+        ts.tv_nsec = (long)(ns % 1000000000);
+        timeout = &ts;
+    }
+    syscall(SYS_futex, unitsWord(&state_), FUTEX_WAIT_PRIVATE, 0, timeout, nullptr, 0);
+    return true;
+}
+
+void Semaphore::wakeOne()
+{
+    syscall(SYS_futex, unitsWord(&state_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+#else
+
+// Sin futex: la espera lenta usa una variable de condición. mutex_ evita que
+// el aviso se pierda entre la verificación de las unidades y la espera
+bool Semaphore::sleep(const chrono::steady_clock::time_point *deadline)
+{
+    unique_lock<mutex> lk(mutex_);
+    auto available = [this]() { return unitsOf(state_.load()) > 0; };
+    if (!deadline) {
+        condition_.wait(lk, available);
+        return true;
+    }
+    return condition_.wait_until(lk, *deadline, available);
+}
+
+void Semaphore::wakeOne()
 {
     lock_guard<mutex> lg(mutex_);
-    condition_.wait(mutex_, [this](){return count_ > 0;});
-    count_--;
+    condition_.notify_one();
 }
+
+#endif
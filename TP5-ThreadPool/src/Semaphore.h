@@ -1,8 +1,13 @@
 #ifndef _semaphore_
 #define _semaphore_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#ifndef __linux__
 #include <condition_variable>
 #include <mutex>
+#endif
 
 using namespace std;
 
@@ -12,6 +17,12 @@ using namespace std;
  *
  * A semaphore is a synchronization primitive that controls access to a shared resource.
  * It allows multiple threads to access the resource concurrently, but with a limited capacity.
+ *
+ * The count and the number of sleeping waiters share a single atomic word: signal()
+ * and a wait() that finds the count positive never take a lock or enter the kernel.
+ * Only a wait() that finds the count at zero sleeps (on a futex on Linux, on a
+ * condition variable elsewhere). On Linux, signal() does not touch the semaphore
+ * after publishing the new count, so a waiter may destroy it as soon as it wakes up.
  */
 class Semaphore 
 {
@@ -20,12 +31,22 @@ class Semaphore
         Semaphore(int count = 0); 
         void signal ();
         void wait(); 
+        bool try_wait();
+        bool wait_for(chrono::milliseconds timeout);
 
     private:
 
-        int count_;
+        bool sleep(const chrono::steady_clock::time_point *deadline);
+        void wakeOne();
+        bool acquire(bool registered);
+
+        // 32 bits bajos: unidades disponibles; 32 altos: hilos que pueden estar
+        // durmiendo (o por dormir) esperando que las unidades dejen de ser cero
+        atomic<uint64_t> state_;
+#ifndef __linux__
         mutex mutex_;
-        condition_variable_any condition_;
+        condition_variable condition_;
+#endif
         
         Semaphore(const Semaphore& orig) = delete;              // no copy constructor
         Semaphore& operator=(const Semaphore& orig) = delete;   // no copy assignment
@@ -7,9 +7,9 @@
 using namespace std;
 
 // Function to compute the sum of a subvector
-void computeSum(const vector<int>& data, int start, int end, int* result) {
+int computeSum(const vector<int>& data, int start, int end) {
 
-    *result = accumulate(data.begin() + start, data.begin() + end, 0);
+    return accumulate(data.begin() + start, data.begin() + end, 0);
 }
 
 int main() {
@@ -18,8 +18,8 @@ int main() {
     int numThreads = 3;
     ThreadPool pool(numThreads);
 
-    // Results vector to hold the sums computed by each thread
-    vector<int> results(numThreads, 0);
+    // Handles to the sums computed by each task
+    vector<TaskFuture<int>> results;
 
     // Determine the size of each chunk of data to process
     int n = data.size();
@@ -30,18 +30,15 @@ int main() {
         int start = i * chunkSize;
         int end = min(start + chunkSize, n);
         if (start < n) {
-            // schedule the task with lambda function
+            // submit the task: the handle carries its return value
             /* lambdas : [capture list] (parameters) -> return type {function body} */
-            pool.schedule([start, end, i, &data, &results](void)-> void {computeSum(data, start, end, &results[i]);});
-            //pool.schedule([start, end, i, &data, &results](){computeSum(data, start, end, &results[i]);});
+            results.push_back(pool.submit([start, end, &data](void)-> int {return computeSum(data, start, end);}));
         }
     }
 
-    // Wait for all threads to finish
-    pool.wait();
-
-    // Calculate total sum
-    int totalSum = accumulate(results.begin(), results.end(), 0);
+    // Wait for each task and calculate total sum
+    int totalSum = 0;
+    for (auto& result : results) totalSum += result.get();
     cout << "Total sum of elements: " << totalSum << endl;
 
     return 0;
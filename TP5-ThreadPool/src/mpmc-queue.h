@@ -0,0 +1,140 @@
+/**
+ * File: mpmc-queue.h
+ * ------------------
+ * Defines MPMCQueue, a bounded lock-free multi-producer/multi-consumer
+ * FIFO ring buffer (Dmitry Vyukov's sequence-number design). Every slot
+ * carries a sequence counter that tells producers and consumers whether
+ * the slot is free or holds a value for their turn, so both ends only
+ * need one compare-and-swap on their own position counter per operation.
+ */
+
+#ifndef _mpmc_queue_
+#define _mpmc_queue_
+
+#include <atomic>     // for atomic
+#include <cstddef>    // for size_t
+#include <cstdint>    // for intptr_t
+#include <memory>     // for unique_ptr
+#include <stdexcept>  // for invalid_argument
+#include <utility>    // for move
+
+using namespace std;
+
+template <typename T>
+class MPMCQueue {
+  public:
+
+  /**
+  * Constructs an empty queue able to hold up to capacity elements.
+  * The capacity must be a power of two (and at least 2).
+  */
+    explicit MPMCQueue(size_t capacity)
+        : mask_(capacity - 1), cells_(new cell_t[capacity]) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+            throw invalid_argument("La capacidad de MPMCQueue debe ser potencia de 2");
+        for (size_t i = 0; i < capacity; i++)
+            cells_[i].seq.store(i, memory_order_relaxed);
+        enqueuePos_.store(0, memory_order_relaxed);
+        dequeuePos_.store(0, memory_order_relaxed);
+    }
+
+  /**
+  * Appends value to the back of the queue. Returns false (leaving value
+  * untouched) if the queue is full.
+  */
+    bool try_push(T&& value) {
+        cell_t *cell;
+        size_t pos = enqueuePos_.load(memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+            if (dif == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1))
+                    break;
+            } else if (dif < 0) {
+                return false; // llena
+            } else {
+                pos = enqueuePos_.load(memory_order_relaxed);
+            }
+        }
+        cell->data = move(value);
+        cell->seq.store(pos + 1, memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T& value) {
+        T copy(value);
+        return try_push(move(copy));
+    }
+
+  /**
+  * Removes the element at the front of the queue into out. Returns false
+  * if the queue is empty (or its front element is still being published).
+  */
+    bool try_pop(T& out) {
+        cell_t *cell;
+        size_t pos = dequeuePos_.load(memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (dif == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1))
+                    break;
+            } else if (dif < 0) {
+                return false; // vacía
+            } else {
+                pos = dequeuePos_.load(memory_order_relaxed);
+            }
+        }
+        out = move(cell->data);
+        cell->data = T();
+        cell->seq.store(pos + mask_ + 1, memory_order_release);
+        return true;
+    }
+
+  /**
+  * Returns true if no element has been claimed for pushing beyond the ones
+  * already popped. Only a snapshot: other threads may change it right away.
+  */
+    bool empty() const {
+        return enqueuePos_.load() == dequeuePos_.load();
+    }
+
+  /**
+  * Approximate number of elements currently in the queue.
+  */
+    size_t size() const {
+        size_t tail = enqueuePos_.load();
+        size_t head = dequeuePos_.load();
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+  private:
+
+    struct cell_t {
+        atomic<size_t> seq;   // turno de la celda (libre para pos, llena para pos + 1)
+        T              data;  // valor almacenado
+    };
+
+    static const size_t kCacheLine = 64;
+
+    // Cada posición queda separada por al menos una línea de caché de lo
+    // que la rodea. Se usa relleno explícito y no alignas para que la cola
+    // (y lo que la contenga) se pueda crear con new sin alineación extendida
+    const size_t              mask_;    // capacidad - 1
+    unique_ptr<cell_t[]>      cells_;   // buffer circular
+    char padHead_[kCacheLine];
+    atomic<size_t>            enqueuePos_;  // próxima posición a escribir
+    char padMiddle_[kCacheLine];
+    atomic<size_t>            dequeuePos_;  // próxima posición a leer
+    char padTail_[kCacheLine];
+
+    MPMCQueue(const MPMCQueue& original) = delete;
+    MPMCQueue& operator=(const MPMCQueue& rhs) = delete;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * File: parallel.h
+ * ----------------
+ * Defines parallel_for and parallel_reduce on top of ThreadPool. The index
+ * range is cut into chunks of `grain` elements (chosen automatically when
+ * grain is 0) and the chunks are handed out by recursive halving: every
+ * task submits the upper half of its chunk range and keeps splitting the
+ * lower half, so idle workers always find big pieces of work to take.
+ * Both functions may be called from inside a pool task.
+ */
+
+#ifndef _parallel_
+#define _parallel_
+
+#include <cstddef>    // for size_t
+#include <exception>  // for exception_ptr
+#include <iterator>   // for begin, end, distance
+#include <vector>     // for vector
+#include "thread-pool.h"
+
+using namespace std;
+
+namespace detail {
+
+    // Acumulador parcial seguido de una línea de caché de relleno, para que
+    // los acumuladores de tareas vecinas no compartan línea (false sharing).
+    // No usa alignas: vector no respeta la alineación extendida antes de C++17
+    template <typename T>
+    struct PaddedSlot {
+        T value;
+        char pad[64];
+        explicit PaddedSlot(const T& v) : value(v) {}
+    };
+
+    // Cantidad de elementos por chunk cuando el usuario no la elige:
+    // alrededor de 4 chunks por hilo (los que puede llegar a tener el pool,
+    // si es elástico) para poder balancear la carga
+    inline size_t autoGrain(const ThreadPool& pool, size_t count) {
+        size_t chunks = pool.maxSize() * 4;
+        if (chunks == 0) chunks = 1;
+        size_t grain = (count + chunks - 1) / chunks;
+        return grain == 0 ? 1 : grain;
+    }
+
+    // Ejecuta leaf(c) para cada chunk c en [first, last) partiendo el rango
+    // por la mitad recursivamente. Espera a todas las mitades que programó
+    // antes de volver (o de propagar la primera excepción)
+    template <typename Leaf>
+    void runChunks(ThreadPool& pool, size_t first, size_t last, const Leaf& leaf) {
+        vector<TaskFuture<void>> pending;
+        exception_ptr error;
+        try {
+            while (last - first > 1) {
+                size_t mid = first + (last - first) / 2;
+                pending.push_back(pool.submit([&pool, mid, last, &leaf] {
+                    runChunks(pool, mid, last, leaf);
+                }));
+                last = mid;
+            }
+            leaf(first);
+        } catch (...) {
+            error = current_exception();
+        }
+        for (auto& f : pending) {
+            try {
+                f.get();
+            } catch (...) {
+                if (!error) error = current_exception();
+            }
+        }
+        if (error) rethrow_exception(error);
+    }
+}
+
+/**
+ * Calls body(i) for every i in [begin, end), in parallel on the pool, in
+ * chunks of grain consecutive indices (grain == 0 picks a size based on the
+ * number of workers). Returns once every call has finished; if any call
+ * throws, the first exception is rethrown after the rest have finished.
+ */
+template <typename Index, typename Body>
+void parallel_for(ThreadPool& pool, Index begin, Index end, size_t grain, const Body& body) {
+    if (!(begin < end)) return;
+    size_t count = (size_t)(end - begin);
+    if (grain == 0) grain = detail::autoGrain(pool, count);
+    size_t chunks = (count + grain - 1) / grain;
+    detail::runChunks(pool, 0, chunks, [begin, count, grain, &body](size_t c) {
+        size_t last = (c + 1) * grain < count ? (c + 1) * grain : count;
+        for (size_t i = c * grain; i < last; i++) body(begin + (Index)i);
+    });
+}
+
+/**
+ * Folds the elements of [first, last) with op, starting from identity, in
+ * parallel on the pool. op must be associative and identity must be its
+ * neutral element; the elements are combined in their original order, so
+ * op need not be commutative.
+ */
+template <typename Iterator, typename T, typename Op>
+T parallel_reduce(ThreadPool& pool, Iterator first, Iterator last, T identity, Op op) {
+    size_t count = (size_t)distance(first, last);
+    if (count == 0) return identity;
+    size_t grain = detail::autoGrain(pool, count);
+    size_t chunks = (count + grain - 1) / grain;
+    vector<detail::PaddedSlot<T>> partials(chunks, detail::PaddedSlot<T>(identity));
+    detail::runChunks(pool, 0, chunks, [first, count, grain, &partials, &op](size_t c) {
+        size_t end = (c + 1) * grain < count ? (c + 1) * grain : count;
+        T acc = partials[c].value;
+        for (Iterator it = first + c * grain; it != first + end; ++it) acc = op(acc, *it);
+        partials[c].value = acc;
+    });
+    T result = identity;
+    for (auto& partial : partials) result = op(result, partial.value);
+    return result;
+}
+
+/**
+ * Same as above over a whole range (anything with random-access begin/end,
+ * such as a vector or an array).
+ */
+template <typename Range, typename T, typename Op>
+T parallel_reduce(ThreadPool& pool, const Range& range, T identity, Op op) {
+    return parallel_reduce(pool, std::begin(range), std::end(range), identity, op);
+}
+
+#endif
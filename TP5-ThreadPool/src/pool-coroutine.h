@@ -0,0 +1,409 @@
+/**
+ * File: pool-coroutine.h
+ * ----------------------
+ * Lets C++20 coroutines run on a ThreadPool (build with make STD=c++20).
+ *
+ *   - `co_await pool` (or `co_await resume_on(pool, priority)`) suspends the
+ *     coroutine and resumes it on one of the pool's workers.
+ *   - CoTask<T> is the coroutine return type: it starts when it is awaited
+ *     from another coroutine, when get() is called (which blocks until it
+ *     finishes) or when it is detached.
+ *   - IoReactor (Linux) suspends a coroutine until a file descriptor is
+ *     readable or writable, or until some time has passed, without keeping
+ *     any worker busy: a single reactor thread waits on epoll and schedules
+ *     the coroutine back on the pool when it is ready.
+ *
+ * A coroutine suspended on an IoReactor is not a task in flight, so
+ * ThreadPool::wait() does not wait for it.
+ */
+
+#ifndef _pool_coroutine_
+#define _pool_coroutine_
+
+#if __cplusplus < 202002L
+#error "pool-coroutine.h requiere C++20 (compilar con make STD=c++20)"
+#endif
+
+#include <atomic>       // for atomic
+#include <chrono>       // for nanoseconds
+#include <coroutine>    // for coroutine_handle, suspend_always, noop_coroutine
+#include <exception>    // for exception_ptr
+#include <mutex>        // for mutex, lock_guard
+#include <optional>     // for optional
+#include <system_error> // for system_error
+#include <thread>       // for thread
+#include <unordered_map> // for unordered_map
+#include <utility>      // for exchange, move
+#include <vector>       // for vector
+#include "Semaphore.h"
+#include "thread-pool.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>    // for epoll_create1, epoll_ctl, epoll_wait
+#include <sys/eventfd.h>  // for eventfd
+#include <sys/timerfd.h>  // for timerfd_create, timerfd_settime
+#include <unistd.h>       // for close, read, write
+#include <cerrno>         // for errno
+#endif
+
+using namespace std;
+
+/**
+ * Awaitable that resumes the awaiting coroutine on a worker of pool.
+ */
+struct PoolAwaiter {
+    ThreadPool& pool;
+    Priority    priority;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(coroutine_handle<> handle) {
+        pool.schedule([handle] { handle.resume(); }, priority);
+    }
+    void await_resume() const noexcept {}
+};
+
+inline PoolAwaiter operator co_await(ThreadPool& pool) {
+    return PoolAwaiter{pool, Priority::Normal};
+}
+
+/**
+ * Same as `co_await pool`, with the given priority.
+ */
+inline PoolAwaiter resume_on(ThreadPool& pool, Priority priority) {
+    return PoolAwaiter{pool, priority};
+}
+
+template <typename T> class CoTask;
+
+namespace detail {
+    // Parte del promise común a todos los CoTask: a quién continuar al
+    // terminar (otra corrutina, un get() bloqueado, o nadie si se desligó)
+    struct CoPromiseBase {
+        coroutine_handle<> continuation;         // corrutina que espera el resultado
+        Semaphore         *finished = nullptr;   // get() esperando
+        bool               detached = false;     // nadie espera: el marco se libera solo
+        exception_ptr      error;                // excepción con la que terminó
+
+        suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            template <typename Promise>
+            coroutine_handle<> await_suspend(coroutine_handle<Promise> handle) noexcept {
+                CoPromiseBase& p = handle.promise();
+                if (p.continuation) return p.continuation;
+                if (p.detached) {
+                    handle.destroy();
+                } else if (p.finished) {
+                    // después de signal() get() puede destruir el marco: no tocarlo más
+                    p.finished->signal();
+                }
+                return noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { error = current_exception(); }
+    };
+
+    template <typename T>
+    struct CoPromise : CoPromiseBase {
+        optional<T> value;
+
+        CoTask<T> get_return_object();
+        template <typename U>
+        void return_value(U&& v) { value.emplace(forward<U>(v)); }
+        T take() {
+            if (error) rethrow_exception(error);
+            return move(*value);
+        }
+    };
+
+    template <>
+    struct CoPromise<void> : CoPromiseBase {
+        CoTask<void> get_return_object();
+        void return_void() {}
+        void take() {
+            if (error) rethrow_exception(error);
+        }
+    };
+}
+
+/**
+ * Move-only handle to a coroutine producing a T. Destroying a CoTask that
+ * has been started but not finished (other than by detach()) is an error.
+ */
+template <typename T = void>
+class CoTask {
+  public:
+    typedef detail::CoPromise<T> promise_type;
+
+    CoTask() = default;
+    explicit CoTask(coroutine_handle<promise_type> handle) : handle_(handle) {}
+    CoTask(CoTask&& other) noexcept : handle_(exchange(other.handle_, nullptr)) {}
+    CoTask& operator=(CoTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle_ = exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~CoTask() { reset(); }
+
+    bool valid() const { return (bool)handle_; }
+
+  /**
+  * Starts the coroutine on the calling thread (it keeps running there until
+  * its first suspension, e.g. `co_await pool`), blocks until it finishes and
+  * returns its result or rethrows its exception.
+  */
+    T get() {
+        Semaphore finished;
+        handle_.promise().finished = &finished;
+        handle_.resume();
+        finished.wait();
+        return handle_.promise().take();
+    }
+
+  /**
+  * Starts the coroutine without waiting for it; its frame is freed when it
+  * finishes. An exception it ends with is discarded.
+  */
+    void detach() {
+        coroutine_handle<promise_type> handle = exchange(handle_, nullptr);
+        handle.promise().detached = true;
+        handle.resume();
+    }
+
+  /**
+  * Awaiting a CoTask from another coroutine starts it right away and
+  * resumes the awaiting coroutine, wherever the awaited one finishes, with
+  * its result.
+  */
+    auto operator co_await() && noexcept {
+        struct awaiter {
+            coroutine_handle<promise_type> handle;
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            coroutine_handle<> await_suspend(coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().take(); }
+        };
+        return awaiter{handle_};
+    }
+
+  private:
+    void reset() {
+        if (handle_) handle_.destroy();
+        handle_ = nullptr;
+    }
+
+    coroutine_handle<promise_type> handle_;
+
+    CoTask(const CoTask& original) = delete;
+    CoTask& operator=(const CoTask& rhs) = delete;
+};
+
+template <typename T>
+CoTask<T> detail::CoPromise<T>::get_return_object() {
+    return CoTask<T>(coroutine_handle<CoPromise<T>>::from_promise(*this));
+}
+
+inline CoTask<void> detail::CoPromise<void>::get_return_object() {
+    return CoTask<void>(coroutine_handle<CoPromise<void>>::from_promise(*this));
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Suspends coroutines on file descriptors and timers without keeping
+ * a worker busy, and resumes them on a ThreadPool.
+ *
+ * One thread per reactor blocks in epoll_wait; when a descriptor a
+ * coroutine is waiting for becomes ready, the coroutine is scheduled back
+ * on the pool. The reactor must be destroyed before the pool, and no
+ * coroutine may still be waiting on it by then.
+ */
+class IoReactor {
+  public:
+
+    // Espera de una corrutina: el reactor guarda acá qué pasó y a quién reanudar
+    struct waiter {
+        waiter(IoReactor *reactor, int fd, uint32_t interest)
+            : reactor(reactor), fd(fd), interest(interest) {}
+
+        IoReactor         *reactor;
+        int                fd;
+        uint32_t           interest;       // EPOLLIN / EPOLLOUT
+        int                ownedFd = -1;   // descriptor propio (timer) a cerrar al terminar
+        uint32_t           events = 0;     // eventos ocurridos
+        coroutine_handle<> handle;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(coroutine_handle<> h) {
+            handle = h;
+            reactor->watch(this);
+        }
+        uint32_t await_resume() const noexcept { return events; }
+    };
+
+    explicit IoReactor(ThreadPool& pool) : pool_(pool) {
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd_ < 0) throw system_error(errno, generic_category(), "epoll_create1");
+        wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wakeFd_ < 0) {
+            close(epollFd_);
+            throw system_error(errno, generic_category(), "eventfd");
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeFd_;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+        thread_ = thread([this] { loop(); });
+    }
+
+    ~IoReactor() {
+        stop_.store(true);
+        uint64_t one = 1;
+        (void)!write(wakeFd_, &one, sizeof(one));
+        thread_.join();
+        close(wakeFd_);
+        close(epollFd_);
+    }
+
+  /**
+  * `co_await reactor.readable(fd)` / `writable(fd)` suspends until fd is
+  * ready and evaluates to the epoll events that occurred (EPOLLIN,
+  * EPOLLOUT, EPOLLHUP, EPOLLERR...). One reader and one writer may wait on
+  * the same fd at a time; a second coroutine waiting for the same direction
+  * of an fd throws system_error(EBUSY). Also throws system_error if fd
+  * cannot be watched (regular files, for example).
+  */
+    waiter readable(int fd) { return waiter(this, fd, EPOLLIN); }
+    waiter writable(int fd) { return waiter(this, fd, EPOLLOUT); }
+
+  /**
+  * `co_await reactor.sleep_for(d)` suspends for (at least) d.
+  */
+    waiter sleep_for(chrono::nanoseconds duration) {
+        int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (fd < 0) throw system_error(errno, generic_category(), "timerfd_create");
+        itimerspec spec{};
+        long long ns = duration.count() > 0 ? duration.count() : 1; // 0 desarma el timer
+        spec.it_value.tv_sec = (time_t)(ns / 1000000000);
+        spec.it_value.tv_nsec = (long)(ns % 1000000000);
+        timerfd_settime(fd, 0, &spec, nullptr);
+        waiter w(this, fd, EPOLLIN);
+        w.ownedFd = fd;
+        return w;
+    }
+
+  private:
+
+    // Esperas pendientes de un descriptor, una por dirección. epoll admite
+    // un solo registro por fd: se arma con la unión de los intereses
+    struct registration {
+        waiter *reader = nullptr;  // espera EPOLLIN
+        waiter *writer = nullptr;  // espera EPOLLOUT
+        uint32_t interest() const {
+            return (reader ? (uint32_t)EPOLLIN : 0) | (writer ? (uint32_t)EPOLLOUT : 0);
+        }
+    };
+
+    // Registra la espera (de un solo disparo). Una vez hecho el epoll_ctl la
+    // corrutina puede reanudarse en otro hilo: no hay que tocar w después
+    void watch(waiter *w) {
+        int fd = w->fd;
+        int error = 0;
+        {
+            lock_guard<mutex> lk(lock_);
+            registration& reg = fds_[fd];
+            waiter *&slot = w->interest == EPOLLIN ? reg.reader : reg.writer;
+            if (slot != nullptr) {
+                error = EBUSY;  // ya hay una corrutina esperando lo mismo en fd
+            } else {
+                slot = w;
+                epoll_event ev{};
+                ev.events = reg.interest() | EPOLLONESHOT;
+                ev.data.fd = fd;
+                // el fd puede seguir en epoll (desarmado) de una espera anterior
+                if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) == 0) return;
+                if (errno == EEXIST && epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev) == 0) return;
+                error = errno;
+                slot = nullptr;
+            }
+            if (reg.interest() == 0) fds_.erase(fd);
+        }
+        if (w->ownedFd >= 0) close(w->ownedFd);
+        throw system_error(error, generic_category(), "IoReactor");
+    }
+
+    // Saca de la registración de fd las esperas que events despierta y vuelve
+    // a armar el fd para las que siguen pendientes. Devuelve las despertadas
+    void takeReady(int fd, uint32_t events, vector<waiter *>& ready) {
+        lock_guard<mutex> lk(lock_);
+        auto it = fds_.find(fd);
+        if (it == fds_.end()) return;
+        registration& reg = it->second;
+        const uint32_t failed = EPOLLERR | EPOLLHUP;
+        if (reg.reader && (events & (EPOLLIN | EPOLLRDHUP | failed))) {
+            ready.push_back(exchange(reg.reader, nullptr));
+        }
+        if (reg.writer && (events & (EPOLLOUT | failed))) {
+            ready.push_back(exchange(reg.writer, nullptr));
+        }
+        for (waiter *w : ready) w->events = events;
+        if (reg.interest() == 0) {
+            fds_.erase(it);
+            return;
+        }
+        // EPOLLONESHOT desarmó todo el fd: rearmarlo para la otra dirección
+        epoll_event ev{};
+        ev.events = reg.interest() | EPOLLONESHOT;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+    }
+
+    void loop() {
+        epoll_event events[64];
+        vector<waiter *> ready;
+        while (!stop_.load()) {
+            int n = epoll_wait(epollFd_, events, 64, -1);
+            for (int i = 0; i < n; i++) {
+                int fd = events[i].data.fd;
+                if (fd == wakeFd_) continue; // despertado para terminar
+                ready.clear();
+                takeReady(fd, events[i].events, ready);
+                for (waiter *w : ready) {
+                    if (w->ownedFd >= 0) {
+                        epoll_ctl(epollFd_, EPOLL_CTL_DEL, w->ownedFd, nullptr);
+                        close(w->ownedFd);
+                    }
+                    coroutine_handle<> handle = w->handle;
+                    try {
+                        pool_.schedule([handle] { handle.resume(); });
+                    } catch (...) {
+                        // pool detenido: la corrutina queda suspendida
+                    }
+                }
+            }
+        }
+    }
+
+    ThreadPool&   pool_;           // pool donde se reanudan las corrutinas
+    int           epollFd_ = -1;
+    int           wakeFd_ = -1;    // para despertar a loop() al destruir el reactor
+    mutex         lock_;           // protege fds_
+    unordered_map<int, registration> fds_; // esperas pendientes por descriptor
+    atomic<bool>  stop_{false};
+    thread        thread_;         // hilo del reactor
+
+    IoReactor(const IoReactor& original) = delete;
+    IoReactor& operator=(const IoReactor& rhs) = delete;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * File: pool-metrics.h
+ * --------------------
+ * Defines the snapshot types returned by ThreadPool::metrics() and, when the
+ * pool is compiled with -DTP_METRICS, the per-worker counters behind them.
+ * Without TP_METRICS the pool keeps no counters or timestamps at all and a
+ * snapshot only reports the current queue depth.
+ */
+
+#ifndef _pool_metrics_
+#define _pool_metrics_
+
+#include <atomic>      // for atomic
+#include <chrono>      // for steady_clock
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <mutex>       // for mutex
+#include <vector>      // for vector
+
+using namespace std;
+
+/**
+ * @brief Histogram of durations in nanoseconds with power-of-two buckets:
+ * bucket 0 counts zero-length samples and bucket b (b > 0) samples in
+ * [2^(b-1), 2^b) ns. The last bucket also takes everything longer.
+ */
+struct LatencyHistogram {
+    static const int kBuckets = 40; // el último cubre desde ~4.6 minutos
+
+    uint64_t buckets[kBuckets] = {};
+
+    static int bucketFor(uint64_t ns) {
+        int b = ns == 0 ? 0 : 64 - __builtin_clzll(ns);
+        return b < kBuckets ? b : kBuckets - 1;
+    }
+
+    uint64_t count() const {
+        uint64_t total = 0;
+        for (uint64_t n : buckets) total += n;
+        return total;
+    }
+
+  /**
+  * Returns an upper bound (in ns) for the p-quantile of the samples, with
+  * p in [0, 1], or 0 if the histogram is empty.
+  */
+    uint64_t percentile(double p) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+        uint64_t rank = (uint64_t)(p * (double)(total - 1));
+        uint64_t seen = 0;
+        for (int b = 0; b < kBuckets; b++) {
+            seen += buckets[b];
+            if (seen > rank) return b == 0 ? 0 : (uint64_t)1 << b;
+        }
+        return (uint64_t)1 << (kBuckets - 1);
+    }
+};
+
+/**
+ * @brief What one worker slot has done since the pool was created.
+ */
+struct WorkerMetrics {
+    uint64_t tasksRun = 0;  // tareas ejecutadas (incluye las ejecutadas mientras ayudaba en una espera)
+    uint64_t busyNs = 0;    // tiempo ejecutando tareas
+    uint64_t idleNs = 0;    // tiempo dormido esperando tareas
+    uint64_t steals = 0;    // tareas robadas a otros trabajadores
+    uint64_t handoffs = 0;  // tareas recibidas directamente mientras dormía
+
+  /**
+  * Fraction of the measured time spent running tasks (0 if none measured).
+  */
+    double busyRatio() const {
+        uint64_t total = busyNs + idleNs;
+        return total == 0 ? 0.0 : (double)busyNs / (double)total;
+    }
+};
+
+/**
+ * @brief Snapshot returned by ThreadPool::metrics(). Counters are read one
+ * by one while the pool keeps running, so they are only mutually consistent
+ * once the pool is idle (for instance right after wait()).
+ */
+struct PoolMetrics {
+    bool                  enabled = false;  // el pool se compiló con TP_METRICS
+    size_t                queueDepth = 0;   // tareas encoladas todavía sin empezar
+    LatencyHistogram      queueWait;        // de schedule() al inicio de cada tarea
+    LatencyHistogram      runTime;          // duración de cada tarea
+    vector<WorkerMetrics> workers;          // uno por lugar de trabajador
+
+    uint64_t tasksRun() const { uint64_t n = 0; for (auto& w : workers) n += w.tasksRun; return n; }
+    uint64_t steals() const { uint64_t n = 0; for (auto& w : workers) n += w.steals; return n; }
+    uint64_t handoffs() const { uint64_t n = 0; for (auto& w : workers) n += w.handoffs; return n; }
+};
+
+#ifdef TP_METRICS
+
+namespace detail {
+    // Reloj monotónico en nanosegundos
+    inline uint64_t nowNs() {
+        return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Suma a un contador que solo escribe su propio trabajador: no hace falta
+    // una operación atómica de lectura-modificación-escritura
+    inline void bump(atomic<uint64_t>& counter, uint64_t amount = 1) {
+        counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+}
+
+/**
+ * Start and end of one task, as recorded for the Chrome trace dump.
+ */
+struct TraceEvent {
+    uint64_t startNs;  // inicio de la tarea
+    uint64_t runNs;    // duración
+    uint64_t waitNs;   // tiempo que esperó en la cola
+};
+
+/**
+ * Counters of one worker slot. Only the worker running in that slot writes
+ * them; metrics() reads them from any thread.
+ */
+struct WorkerStats {
+    atomic<uint64_t>   tasksRun{0};
+    atomic<uint64_t>   busyNs{0};
+    atomic<uint64_t>   idleNs{0};
+    atomic<uint64_t>   steals{0};
+    atomic<uint64_t>   handoffs{0};
+    atomic<uint64_t>   waitHist[LatencyHistogram::kBuckets] = {};
+    atomic<uint64_t>   runHist[LatencyHistogram::kBuckets] = {};
+    bool               running = false;  // ya está ejecutando una tarea (ayudando en una espera)
+    vector<TraceEvent> trace;            // eventos grabados mientras la traza está activa
+    mutable mutex      traceLock;        // protege trace
+};
+
+#endif
+
+#endif
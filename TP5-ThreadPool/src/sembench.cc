@@ -0,0 +1,118 @@
+/**
+ * File: sembench.cc
+ * -----------------
+ * Microbenchmark for Semaphore. Measures the uncontended signal()+wait()
+ * pair, try_wait() on an empty semaphore, and the cost of one handoff
+ * between two threads that wake each other up in turn (the pattern the
+ * ThreadPool uses to hand a task to a parked worker). The same cases run on
+ * a mutex + condition variable semaphore, the previous implementation, as
+ * a baseline. Prints one JSON object per line, like tpbench.
+ *
+ *   ./sembench [--iterations N]
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Semaphore.h"
+
+using namespace std;
+
+typedef chrono::steady_clock benchClock;
+
+static volatile size_t sink; // evita que el compilador descarte los resultados
+
+// Semáforo anterior (mutex + variable de condición en cada operación)
+class condvarSemaphore {
+  public:
+    explicit condvarSemaphore(int count = 0) : count_(count) {}
+    void signal() {
+        lock_guard<mutex> lg(mutex_);
+        count_++;
+        if (count_ == 1) condition_.notify_all();
+    }
+    void wait() {
+        unique_lock<mutex> lk(mutex_);
+        condition_.wait(lk, [this] { return count_ > 0; });
+        count_--;
+    }
+    bool try_wait() {
+        lock_guard<mutex> lg(mutex_);
+        if (count_ == 0) return false;
+        count_--;
+        return true;
+    }
+
+  private:
+    int count_;
+    mutex mutex_;
+    condition_variable condition_;
+};
+
+static void report(const string& impl, const string& name, size_t ops, double secs) {
+    cout << "{\"semaphore\":\"" << impl << "\",\"case\":\"" << name << "\",\"ops\":" << ops
+         << ",\"ns_per_op\":" << secs * 1e9 / ops << "}" << endl;
+}
+
+template <typename Sem>
+static void runCases(const string& impl, size_t iterations) {
+    {
+        Sem sem(0);
+        benchClock::time_point start = benchClock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            sem.signal();
+            sem.wait();
+        }
+        report(impl, "signal-wait-uncontended", iterations,
+               chrono::duration<double>(benchClock::now() - start).count());
+    }
+    {
+        Sem sem(0);
+        size_t acquired = 0;
+        benchClock::time_point start = benchClock::now();
+        for (size_t i = 0; i < iterations; i++) acquired += sem.try_wait();
+        double secs = chrono::duration<double>(benchClock::now() - start).count();
+        sink = acquired;
+        report(impl, "try-wait-empty", iterations, secs);
+    }
+    {
+        // dos hilos se despiertan alternadamente: cada vuelta son dos entregas
+        Sem ping(0), pong(0);
+        size_t rounds = iterations / 10;
+        thread partner([&ping, &pong, rounds] {
+            for (size_t i = 0; i < rounds; i++) {
+                ping.wait();
+                pong.signal();
+            }
+        });
+        benchClock::time_point start = benchClock::now();
+        for (size_t i = 0; i < rounds; i++) {
+            ping.signal();
+            pong.wait();
+        }
+        double secs = chrono::duration<double>(benchClock::now() - start).count();
+        partner.join();
+        report(impl, "handoff-ping-pong", rounds * 2, secs);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t iterations = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = strtoul(argv[++i], nullptr, 10);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--iterations N]" << endl;
+            return 1;
+        }
+    }
+    runCases<Semaphore>("atomic", iterations);
+    runCases<condvarSemaphore>("mutex-condvar", iterations);
+    return 0;
+}
@@ -0,0 +1,261 @@
+/**
+ * File: task-future.h
+ * -------------------
+ * Defines TaskFuture, the handle returned by ThreadPool::submit. A single
+ * heap block (the SubmitState) holds the callable, its arguments and the
+ * slot for its result or exception; both the handle and the scheduled
+ * thunk point at it, and it is freed when both are done with it.
+ */
+
+#ifndef _task_future_
+#define _task_future_
+
+#include <atomic>              // for atomic
+#include <condition_variable>  // for condition_variable
+#include <exception>           // for exception_ptr
+#include <future>              // for future_error
+#include <mutex>               // for mutex
+#include <new>                 // for placement new
+#include <stdexcept>           // for logic_error
+#include <tuple>               // for tuple
+#include <type_traits>         // for decay, aligned_storage
+#include <utility>             // for move, forward
+
+using namespace std;
+
+class ThreadPool;
+
+/**
+ * Type-independent part of a submitted task's shared state: reference
+ * count, completion flag and the machinery to block until completion.
+ */
+class TaskStateBase {
+  public:
+
+  /**
+  * Blocks until the task has finished. When called from one of the pool's
+  * own workers, runs other pending tasks of the pool while it waits instead
+  * of sleeping, so tasks can wait on the tasks they submit.
+  */
+    void wait();
+
+    bool ready() const { return ready_.load(memory_order_acquire); }
+
+    void retain() { refs_.fetch_add(1, memory_order_relaxed); }
+    void release() {
+        if (refs_.fetch_sub(1, memory_order_acq_rel) == 1) delete this;
+    }
+
+    virtual void run() = 0;
+
+  /**
+  * Completes the task without running it, as if it had thrown
+  * future_error(broken_promise). Used when its thunk is discarded.
+  */
+    void abandon() {
+        error_ = make_exception_ptr(future_error(future_errc::broken_promise));
+        markReady();
+    }
+
+  protected:
+
+    explicit TaskStateBase(ThreadPool *pool) : pool_(pool) {}
+    virtual ~TaskStateBase() {}
+
+    void markReady();
+    void rethrowIfFailed() { if (error_) rethrow_exception(error_); }
+
+    ThreadPool         *pool_;             // pool donde corre la tarea
+    exception_ptr       error_;            // excepción lanzada por la tarea, si hubo
+    atomic<int>         refs_{1};          // referencias (handle y tarea encolada)
+    atomic<bool>        ready_{false};     // la tarea terminó
+    atomic<int>         waiters_{0};       // hilos bloqueados en cv_
+    mutex               mtx_;              // acompaña a cv_
+    condition_variable  cv_;               // espera hasta que ready_ sea true
+
+  private:
+    TaskStateBase(const TaskStateBase& original) = delete;
+    TaskStateBase& operator=(const TaskStateBase& rhs) = delete;
+};
+
+/**
+ * Shared state holding the result of type R inline.
+ */
+template <typename R>
+class TaskState : public TaskStateBase {
+  public:
+    R take() {
+        rethrowIfFailed();
+        return move(*reinterpret_cast<R *>(&value_));
+    }
+
+  protected:
+    explicit TaskState(ThreadPool *pool) : TaskStateBase(pool) {}
+    ~TaskState() {
+        if (hasValue_) reinterpret_cast<R *>(&value_)->~R();
+    }
+
+    template <typename Fn>
+    void complete(Fn&& fn) {
+        try {
+            new (&value_) R(fn());
+            hasValue_ = true;
+        } catch (...) {
+            error_ = current_exception();
+        }
+        markReady();
+    }
+
+  private:
+    typename aligned_storage<sizeof(R), alignof(R)>::type value_;  // resultado
+    bool hasValue_ = false;
+};
+
+template <>
+class TaskState<void> : public TaskStateBase {
+  public:
+    void take() { rethrowIfFailed(); }
+
+  protected:
+    explicit TaskState(ThreadPool *pool) : TaskStateBase(pool) {}
+
+    template <typename Fn>
+    void complete(Fn&& fn) {
+        try {
+            fn();
+        } catch (...) {
+            error_ = current_exception();
+        }
+        markReady();
+    }
+};
+
+namespace detail {
+    // index_sequence de C++14, para desempaquetar la tupla de argumentos
+    template <size_t... I> struct index_seq {};
+    template <size_t N, size_t... I>
+    struct make_index_seq : make_index_seq<N - 1, N - 1, I...> {};
+    template <size_t... I>
+    struct make_index_seq<0, I...> { typedef index_seq<I...> type; };
+}
+
+/**
+ * Concrete state for a submitted callable F with decayed arguments Args.
+ */
+template <typename R, typename F, typename... Args>
+class SubmitState : public TaskState<R> {
+  public:
+    template <typename G, typename... A>
+    SubmitState(ThreadPool *pool, G&& fn, A&&... args)
+        : TaskState<R>(pool), fn_(forward<G>(fn)), args_(forward<A>(args)...) {}
+
+    void run() override {
+        this->complete([this]() -> R {
+            return call(typename detail::make_index_seq<sizeof...(Args)>::type());
+        });
+    }
+
+  private:
+    template <size_t... I>
+    R call(detail::index_seq<I...>) {
+        return move(fn_)(move(get<I>(args_))...);
+    }
+
+    F              fn_;    // función a ejecutar
+    tuple<Args...> args_;  // argumentos ya copiados/movidos
+};
+
+namespace detail {
+    // Tarea que encola submit(): ejecuta el estado compartido y suelta su
+    // referencia. Si se destruye sin haberse ejecutado (descartada al cerrar
+    // el pool), el handle recibe broken_promise en vez de esperar para siempre
+    struct SubmitTask {
+        explicit SubmitTask(TaskStateBase *state) : state(state) {}
+        SubmitTask(SubmitTask&& other) noexcept : state(other.state) { other.state = nullptr; }
+        ~SubmitTask() {
+            if (state) {
+                state->abandon();
+                state->release();
+            }
+        }
+        void operator()() {
+            TaskStateBase *s = state;
+            state = nullptr;
+            s->run();
+            s->release();
+        }
+
+        TaskStateBase *state;
+
+        SubmitTask(const SubmitTask& original) = delete;
+        SubmitTask& operator=(const SubmitTask& rhs) = delete;
+    };
+}
+
+/**
+ * Move-only handle to the result of a task submitted with ThreadPool::submit.
+ * Like std::future, get() may be called only once.
+ */
+template <typename R>
+class TaskFuture {
+  public:
+    TaskFuture() : state_(nullptr) {}
+    explicit TaskFuture(TaskState<R> *state) : state_(state) {}
+    TaskFuture(TaskFuture&& other) : state_(other.state_) { other.state_ = nullptr; }
+    TaskFuture& operator=(TaskFuture&& other) {
+        if (this != &other) {
+            reset();
+            state_ = other.state_;
+            other.state_ = nullptr;
+        }
+        return *this;
+    }
+    ~TaskFuture() { reset(); }
+
+  /**
+  * Returns true while the handle refers to a task whose result has not
+  * been retrieved with get().
+  */
+    bool valid() const { return state_ != nullptr; }
+
+  /**
+  * Returns true if the task has already finished.
+  */
+    bool ready() const { return state_ != nullptr && state_->ready(); }
+
+  /**
+  * Blocks until the task has finished.
+  */
+    void wait() const {
+        if (!state_) throw logic_error("TaskFuture sin estado");
+        state_->wait();
+    }
+
+  /**
+  * Blocks until the task has finished and returns its result, or rethrows
+  * the exception it ended with. Leaves the handle invalid.
+  */
+    R get() {
+        wait();
+        TaskState<R> *state = state_;
+        state_ = nullptr;
+        struct releaser {
+            TaskState<R> *s;
+            ~releaser() { s->release(); }
+        } guard{state};
+        return state->take();
+    }
+
+  private:
+    void reset() {
+        if (state_) state_->release();
+        state_ = nullptr;
+    }
+
+    TaskState<R> *state_;  // estado compartido con la tarea
+
+    TaskFuture(const TaskFuture& original) = delete;
+    TaskFuture& operator=(const TaskFuture& rhs) = delete;
+};
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ * File: task-graph.h
+ * ------------------
+ * Defines TaskGraph, a set of thunks with "runs before" edges between them
+ * that executes on a ThreadPool without barriers: every thunk is scheduled
+ * as soon as the last of its predecessors finishes. Each node keeps an
+ * atomic count of predecessors still running; the one that brings it to
+ * zero launches the node (continuing with it on the same worker when it is
+ * the first successor to become ready, and scheduling the rest).
+ */
+
+#ifndef _task_graph_
+#define _task_graph_
+
+#include <atomic>      // for atomic
+#include <cstddef>     // for size_t
+#include <exception>   // for exception_ptr
+#include <memory>      // for unique_ptr
+#include <stdexcept>   // for invalid_argument, logic_error, out_of_range
+#include <utility>     // for forward, move
+#include <vector>      // for vector
+#include "task.h"
+#include "thread-pool.h"
+
+using namespace std;
+
+class TaskGraph {
+  public:
+    explicit TaskGraph(ThreadPool& pool) : group_(pool) {}
+
+  /**
+  * Waits for a run still in progress (without rethrowing its exception).
+  */
+    ~TaskGraph() { group_.wait(); }
+
+  /**
+  * Adds a node that will call thunk and returns its id (ids are assigned
+  * consecutively from 0).
+  */
+    template <typename F>
+    size_t add(F&& thunk);
+
+  /**
+  * Adds the edge before -> after: after starts only once before finished.
+  */
+    void precede(size_t before, size_t after);
+
+  /**
+  * Adds a node that runs thunk after node before, and returns its id.
+  */
+    template <typename F>
+    size_t then(size_t before, F&& thunk) {
+        size_t id = add(forward<F>(thunk));
+        precede(before, id);
+        return id;
+    }
+
+  /**
+  * Starts executing the graph and returns right away; nodes without
+  * predecessors are scheduled immediately. Throws invalid_argument (and
+  * runs nothing) if the edges form a cycle. A finished graph may be run
+  * again after wait().
+  */
+    void run();
+
+  /**
+  * Blocks until every node of the current run has finished. If a node
+  * threw, the nodes that had not started yet are skipped and the first
+  * exception is rethrown here. Called from a worker of the pool, it runs
+  * other pending tasks while it waits.
+  */
+    void wait();
+
+    size_t size() const { return nodes_.size(); }
+
+  private:
+
+    struct node_t {
+        Task           thunk;            // función del nodo
+        vector<size_t> successors;       // nodos que dependen de este
+        size_t         predecessors = 0; // aristas entrantes
+    };
+
+    static const size_t kNone = (size_t)-1;
+
+    void checkIdle() const {
+        if (running_) throw logic_error("No se puede modificar un TaskGraph en ejecución");
+    }
+    void runFrom(size_t id);
+
+    vector<node_t>                nodes_;
+    unique_ptr<atomic<size_t>[]>  pending_;        // predecesores sin terminar en esta corrida
+    bool                          running_ = false; // hubo run() sin su wait()
+    atomic<bool>                  failed_{false};   // algún nodo lanzó una excepción
+    exception_ptr                 error_;           // la primera de esas excepciones
+    TaskGroup                     group_;           // tareas de la corrida (se destruye primero)
+
+    TaskGraph(const TaskGraph& original) = delete;
+    TaskGraph& operator=(const TaskGraph& rhs) = delete;
+};
+
+template <typename F>
+size_t TaskGraph::add(F&& thunk) {
+    checkIdle();
+    Task task(forward<F>(thunk));
+    if (!task) throw invalid_argument("Tarea vacía no permitida");
+    nodes_.push_back(node_t());
+    nodes_.back().thunk = move(task);
+    return nodes_.size() - 1;
+}
+
+inline void TaskGraph::precede(size_t before, size_t after) {
+    checkIdle();
+    if (before >= nodes_.size() || after >= nodes_.size())
+        throw out_of_range("Nodo inexistente en TaskGraph");
+    nodes_[before].successors.push_back(after);
+    nodes_[after].predecessors++;
+}
+
+inline void TaskGraph::run() {
+    checkIdle();
+    // Kahn: si no se pueden visitar todos los nodos, hay un ciclo
+    vector<size_t> indegree(nodes_.size());
+    vector<size_t> ready;
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        indegree[i] = nodes_[i].predecessors;
+        if (indegree[i] == 0) ready.push_back(i);
+    }
+    vector<size_t> roots(ready);
+    size_t visited = 0;
+    while (!ready.empty()) {
+        size_t id = ready.back();
+        ready.pop_back();
+        visited++;
+        for (size_t s : nodes_[id].successors) {
+            if (--indegree[s] == 0) ready.push_back(s);
+        }
+    }
+    if (visited != nodes_.size()) throw invalid_argument("El TaskGraph tiene un ciclo");
+
+    pending_.reset(new atomic<size_t>[nodes_.size()]);
+    for (size_t i = 0; i < nodes_.size(); i++) pending_[i].store(nodes_[i].predecessors);
+    failed_.store(false);
+    error_ = nullptr;
+    running_ = true;
+    for (size_t id : roots) group_.schedule([this, id] { runFrom(id); });
+}
+
+inline void TaskGraph::wait() {
+    group_.wait();
+    running_ = false;
+    if (error_) {
+        exception_ptr error = error_;
+        error_ = nullptr;
+        rethrow_exception(error);
+    }
+}
+
+// Ejecuta el nodo id y libera a sus sucesores: sigue en este mismo hilo con
+// el primero que quede listo y programa los demás. Tras una excepción los
+// nodos restantes no ejecutan su función, pero igual liberan a sus sucesores
+// para que la corrida termine
+inline void TaskGraph::runFrom(size_t id) {
+    while (id != kNone) {
+        node_t& node = nodes_[id];
+        if (!failed_.load()) {
+            try {
+                node.thunk();
+            } catch (...) {
+                if (!failed_.exchange(true)) error_ = current_exception();
+            }
+        }
+        size_t next = kNone;
+        for (size_t s : node.successors) {
+            if (pending_[s].fetch_sub(1, memory_order_acq_rel) != 1) continue;
+            if (next == kNone) next = s;
+            else group_.schedule([this, s] { runFrom(s); });
+        }
+        id = next;
+    }
+}
+
+#endif
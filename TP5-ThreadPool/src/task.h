@@ -0,0 +1,306 @@
+/**
+ * File: task.h
+ * ------------
+ * Defines Task, the move-only type-erased thunk the ThreadPool stores in its
+ * queues, together with the node slab and intrusive deque used for the
+ * queues that grow without bound. A Task keeps any callable of up to
+ * Task::kInlineSize bytes inside itself, so scheduling a capturing lambda
+ * does not allocate; only larger callables fall back to the heap.
+ */
+
+#ifndef _task_
+#define _task_
+
+#include <atomic>       // for atomic
+#include <cstddef>      // for size_t, max_align_t
+#include <cstdint>      // for uint64_t
+#include <functional>   // for function
+#include <memory>       // for unique_ptr
+#include <new>          // for placement new
+#include <type_traits>  // for decay, enable_if
+#include <utility>      // for move, forward
+#include <vector>       // for vector
+
+using namespace std;
+
+namespace detail {
+    // Permite detectar callables nulos (function vacía o puntero nulo)
+    template <typename F> bool isNullCallable(const F&) { return false; }
+    template <typename S> bool isNullCallable(const function<S>& f) { return !f; }
+    template <typename R> bool isNullCallable(R (*const& f)()) { return f == nullptr; }
+}
+
+class Task {
+  public:
+
+    static const size_t kInlineSize = 64; // bytes disponibles sin usar el heap
+
+    Task() : ops_(nullptr) {}
+
+  /**
+  * Wraps any zero-argument callable. Null callables (an empty function or
+  * a null function pointer) produce an empty Task.
+  */
+    template <typename F,
+              typename = typename enable_if<!is_same<typename decay<F>::type, Task>::value>::type>
+    Task(F&& fn) : ops_(nullptr) {
+        typedef typename decay<F>::type fn_t;
+        if (detail::isNullCallable(fn)) return;
+        store(forward<F>(fn), integral_constant<bool, fitsInline<fn_t>()>());
+    }
+
+    Task(Task&& other) noexcept : ops_(other.ops_) {
+#ifdef TP_METRICS
+        queuedAt = other.queuedAt;
+#endif
+        if (ops_) {
+            ops_->move(buf_, other.buf_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+#ifdef TP_METRICS
+            queuedAt = other.queuedAt;
+#endif
+            if (other.ops_) {
+                other.ops_->move(buf_, other.buf_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Task& operator=(nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    ~Task() { reset(); }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+    void operator()() { ops_->invoke(buf_); }
+
+#ifdef TP_METRICS
+    uint64_t queuedAt = 0; // instante en que se programó (ns, ver pool-metrics.h)
+#endif
+
+  private:
+
+    struct ops_t {
+        void (*invoke)(void *self);
+        void (*move)(void *dst, void *src);  // construye en dst y destruye src
+        void (*destroy)(void *self);
+    };
+
+    template <typename F>
+    static constexpr bool fitsInline() {
+        return sizeof(F) <= kInlineSize && alignof(F) <= alignof(max_align_t) &&
+               is_nothrow_move_constructible<F>::value;
+    }
+
+    // El callable vive dentro de buf_
+    template <typename F>
+    struct inlineOps {
+        static void invoke(void *self) { (*static_cast<F *>(self))(); }
+        static void move(void *dst, void *src) {
+            new (dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+        }
+        static void destroy(void *self) { static_cast<F *>(self)->~F(); }
+        static const ops_t ops;
+    };
+
+    // buf_ solo guarda un puntero al callable en el heap
+    template <typename F>
+    struct heapOps {
+        static void invoke(void *self) { (**static_cast<F **>(self))(); }
+        static void move(void *dst, void *src) {
+            *static_cast<F **>(dst) = *static_cast<F **>(src);
+        }
+        static void destroy(void *self) { delete *static_cast<F **>(self); }
+        static const ops_t ops;
+    };
+
+    template <typename F>
+    void store(F&& fn, true_type /* entra en buf_ */) {
+        typedef typename decay<F>::type fn_t;
+        new (buf_) fn_t(forward<F>(fn));
+        ops_ = &inlineOps<fn_t>::ops;
+    }
+
+    template <typename F>
+    void store(F&& fn, false_type /* va al heap */) {
+        typedef typename decay<F>::type fn_t;
+        *reinterpret_cast<fn_t **>(buf_) = new fn_t(forward<F>(fn));
+        ops_ = &heapOps<fn_t>::ops;
+    }
+
+    void reset() {
+        if (ops_) ops_->destroy(buf_);
+        ops_ = nullptr;
+    }
+
+    alignas(max_align_t) unsigned char buf_[kInlineSize]; // almacenamiento del callable
+    const ops_t *ops_;                                    // operaciones del tipo guardado
+
+    Task(const Task& original) = delete;
+    Task& operator=(const Task& rhs) = delete;
+};
+
+template <typename F>
+const Task::ops_t Task::inlineOps<F>::ops = {
+    &Task::inlineOps<F>::invoke, &Task::inlineOps<F>::move, &Task::inlineOps<F>::destroy};
+
+template <typename F>
+const Task::ops_t Task::heapOps<F>::ops = {
+    &Task::heapOps<F>::invoke, &Task::heapOps<F>::move, &Task::heapOps<F>::destroy};
+
+namespace detail {
+    // Función por índice de ThreadPool::schedule_n, guardada una sola vez y
+    // compartida por todas las tareas del lote
+    template <typename F>
+    struct SharedIndexFn {
+        template <typename G>
+        explicit SharedIndexFn(G&& fn) : fn(forward<G>(fn)) {}
+        void retain() { refs.fetch_add(1, memory_order_relaxed); }
+        void release() {
+            if (refs.fetch_sub(1, memory_order_acq_rel) == 1) delete this;
+        }
+        F              fn;
+        atomic<size_t> refs{1}; // la del que arma el lote más una por tarea
+    };
+
+    // Tarea i de un lote de schedule_n: llama a fn(i) y suelta su referencia
+    // al destruirse (haya corrido o no)
+    template <typename F>
+    struct IndexTask {
+        IndexTask(SharedIndexFn<F> *shared, size_t index) : shared(shared), index(index) {
+            shared->retain();
+        }
+        IndexTask(IndexTask&& other) noexcept : shared(other.shared), index(other.index) {
+            other.shared = nullptr;
+        }
+        ~IndexTask() { if (shared) shared->release(); }
+        void operator()() { shared->fn(index); }
+
+        SharedIndexFn<F> *shared;
+        size_t            index;
+
+        IndexTask(const IndexTask& original) = delete;
+        IndexTask& operator=(const IndexTask& rhs) = delete;
+    };
+
+    // Mueve los elementos de un rango pasado como rvalue y copia los de uno
+    // pasado como lvalue
+    template <typename Range, typename T>
+    typename conditional<is_lvalue_reference<Range>::value, T&, T&&>::type
+    forwardElement(T& element) {
+        return static_cast<typename conditional<is_lvalue_reference<Range>::value, T&, T&&>::type>(element);
+    }
+}
+
+/**
+ * Queue node holding one Task; nodes are linked intrusively.
+ */
+struct TaskNode {
+    Task      task;
+    TaskNode *prev = nullptr;
+    TaskNode *next = nullptr;
+};
+
+/**
+ * Fixed-size allocator of TaskNodes. Nodes are carved from chunks of
+ * kChunkNodes and recycled through a free list; chunks are only returned to
+ * the system when the slab is destroyed. Not thread-safe: each slab is
+ * protected by its owner's lock. A node must be freed into the slab it was
+ * allocated from.
+ */
+class TaskSlab {
+  public:
+    TaskSlab() : free_(nullptr) {}
+
+    TaskNode *allocate(Task&& task) {
+        if (free_ == nullptr) grow();
+        TaskNode *node = free_;
+        free_ = node->next;
+        node->task = move(task);
+        node->prev = node->next = nullptr;
+        return node;
+    }
+
+    void free(TaskNode *node) {
+        node->task = nullptr;
+        node->prev = nullptr;
+        node->next = free_;
+        free_ = node;
+    }
+
+  private:
+    static const size_t kChunkNodes = 256;
+
+    void grow() {
+        chunks_.emplace_back(new TaskNode[kChunkNodes]);
+        TaskNode *chunk = chunks_.back().get();
+        for (size_t i = 0; i < kChunkNodes; i++) {
+            chunk[i].next = free_;
+            free_ = &chunk[i];
+        }
+    }
+
+    TaskNode                       *free_;   // lista de nodos libres
+    vector<unique_ptr<TaskNode[]>>  chunks_; // bloques pedidos al sistema
+
+    TaskSlab(const TaskSlab& original) = delete;
+    TaskSlab& operator=(const TaskSlab& rhs) = delete;
+};
+
+/**
+ * Intrusive double-ended queue of TaskNodes. It never allocates: nodes come
+ * from (and go back to) a TaskSlab chosen by the caller.
+ */
+class TaskDeque {
+  public:
+    TaskDeque() : head_(nullptr), tail_(nullptr), size_(0) {}
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    void push_back(TaskNode *node) {
+        node->prev = tail_;
+        node->next = nullptr;
+        if (tail_) tail_->next = node; else head_ = node;
+        tail_ = node;
+        size_++;
+    }
+
+    TaskNode *pop_front() {
+        TaskNode *node = head_;
+        head_ = node->next;
+        if (head_) head_->prev = nullptr; else tail_ = nullptr;
+        size_--;
+        return node;
+    }
+
+    TaskNode *pop_back() {
+        TaskNode *node = tail_;
+        tail_ = node->prev;
+        if (tail_) tail_->next = nullptr; else head_ = nullptr;
+        size_--;
+        return node;
+    }
+
+  private:
+    TaskNode *head_;  // el más antiguo
+    TaskNode *tail_;  // el más reciente
+    size_t    size_;
+
+    TaskDeque(const TaskDeque& original) = delete;
+    TaskDeque& operator=(const TaskDeque& rhs) = delete;
+};
+
+#endif
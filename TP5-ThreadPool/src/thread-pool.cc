@@ -5,87 +5,761 @@
  */
 
 #include "thread-pool.h"
+#include <algorithm>   // for find, sort
+#include <chrono>      // for milliseconds
+#include <string>      // for string
+#ifdef __linux__
+#include <dirent.h>    // for opendir, readdir, closedir
+#include <fstream>     // for ifstream
+#include <pthread.h>   // for pthread_setaffinity_np
+#include <sched.h>     // for sched_getaffinity, sched_getcpu
+#endif
 using namespace std;
 
-// Constructor: inicia despachador y hilos trabajadores
-ThreadPool::ThreadPool(size_t numThreads) : wts(numThreads), done(false) {
+// Pool y trabajador que está ejecutando el hilo actual (nullptr / -1 fuera del pool)
+static thread_local ThreadPool *currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+// CPUs en las que el proceso puede ejecutar
+static vector<int> allowedCpus() {
+    vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+#endif
+    if (cpus.empty()) {
+        unsigned n = thread::hardware_concurrency();
+        for (unsigned cpu = 0; cpu < (n == 0 ? 1 : n); cpu++) cpus.push_back((int)cpu);
+    }
+    return cpus;
+}
+
+#ifdef __linux__
+// Convierte una lista de CPUs de sysfs ("0-3,8-11") en sus números
+static vector<int> parseCpuList(const string& list) {
+    vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == string::npos) end = list.size();
+        string range = list.substr(pos, end - pos);
+        size_t dash = range.find('-');
+        if (!range.empty()) {
+            int first = stoi(range);
+            int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+#endif
+
+// CPUs de cada nodo NUMA del sistema (un único nodo si no se pueden leer)
+static vector<vector<int>> detectNumaNodes() {
+    vector<pair<int, vector<int>>> found;
+#ifdef __linux__
+    const string root = "/sys/devices/system/node/";
+    DIR *dir = opendir(root.c_str());
+    if (dir != nullptr) {
+        while (struct dirent *entry = readdir(dir)) {
+            string name = entry->d_name;
+            if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+                name.find_first_not_of("0123456789", 4) != string::npos) continue;
+            ifstream in(root + name + "/cpulist");
+            string list;
+            if (!getline(in, list)) continue;
+            vector<int> cpus = parseCpuList(list);
+            if (!cpus.empty()) found.push_back(make_pair(stoi(name.substr(4)), cpus));
+        }
+        closedir(dir);
+    }
+#endif
+    sort(found.begin(), found.end());
+    vector<vector<int>> nodes;
+    for (auto& node : found) nodes.push_back(node.second);
+    if (nodes.empty()) nodes.push_back(allowedCpus());
+    return nodes;
+}
+
+Placement Placement::pinToCores() {
+    Placement placement;
+    for (int cpu : allowedCpus()) placement.cpuSets.push_back(vector<int>(1, cpu));
+    return placement;
+}
+
+Placement Placement::numaAware() {
+    Placement placement;
+    placement.numa = true;
+    return placement;
+}
+
+// Constructor de tamaño fijo: un pool elástico con mínimo igual al máximo
+ThreadPool::ThreadPool(size_t numThreads, SchedulingMode mode, const Placement& placement)
+    : ThreadPool(ElasticConfig(numThreads, numThreads), mode, placement) {}
+
+// Constructor: inicia los hilos trabajadores mínimos (no hay hilo despachador,
+// cada trabajador toma tareas directamente de las colas de su nodo)
+ThreadPool::ThreadPool(const ElasticConfig& config, SchedulingMode mode, const Placement& placement)
+    : mode_(mode), minThreads_(config.minThreads), maxThreads_(config.maxThreads),
+      idleTimeout_(config.idleTimeout), spawnQueueDepth_(config.spawnQueueDepth),
+      wts(config.maxThreads), done(false) {
+    if (minThreads_ > maxThreads_)
+        throw invalid_argument("El mínimo de hilos no puede superar al máximo");
+    // Nodos NUMA: cada uno con sus colas, y cada CPU asociada a su nodo para
+    // saber dónde encolar lo que se programa desde fuera del pool
+    vector<vector<int>> nodes;
+    if (placement.numa) nodes = placement.numaNodes.empty() ? detectNumaNodes() : placement.numaNodes;
+    numNodes_ = nodes.empty() ? 1 : nodes.size();
+    lanes_.reset(new lane_t[numNodes_ * kNumPriorities]);
+    for (size_t node = 0; node < nodes.size(); node++) {
+        for (int cpu : nodes[node]) {
+            if (cpu < 0) throw invalid_argument("Número de CPU inválido");
+            if ((size_t)cpu >= cpuNode_.size()) cpuNode_.resize(cpu + 1, -1);
+            if (cpuNode_[cpu] < 0) cpuNode_[cpu] = (int)node;
+        }
+    }
+    for (const vector<int>& cpus : placement.cpuSets) {
+        for (int cpu : cpus) if (cpu < 0) throw invalid_argument("Número de CPU inválido");
+    }
+    // Los trabajadores se reparten por turnos entre los nodos
+    for (size_t i = 0; i < wts.size(); ++i) {
+        wts[i].node = (int)(i % numNodes_);
+        if (!placement.cpuSets.empty()) wts[i].cpus = placement.cpuSets[i % placement.cpuSets.size()];
+        else if (!nodes.empty()) wts[i].cpus = nodes[wts[i].node];
+    }
+    idleWorkers_.reserve(maxThreads_);
+    // Los lugares sin hilo se usan del final hacia el principio
+    for (size_t i = maxThreads_; i > minThreads_; --i) freeSlots_.push_back((int)i - 1);
     // Inicializar cada trabajador y su hilo
     for (size_t i = 0; i < wts.size(); ++i) {
-        wts[i].available = true;
-        wts[i].ts = thread(&ThreadPool::worker, this, (int)i);
+        wts[i].available = false;
+        if (i < minThreads_) wts[i].ts = thread(&ThreadPool::worker, this, (int)i);
+    }
+    liveWorkers_.store(minThreads_);
+}
+
+void ThreadPool::schedule(const function<void()>& thunk, Priority priority) {
+    scheduleTask(Task(thunk), priority);
+}
+
+// Programa una tarea: si hay un trabajador dormido se la entrega directamente,
+// si no la deja en la cola para que la tome el próximo trabajador que se libere.
+// Con trabajadores ocupados no toma ningún mutex.
+void ThreadPool::scheduleTask(Task&& task, Priority priority) {
+    if (!task) throw invalid_argument("Tarea vacía no permitida");
+#ifdef TP_METRICS
+    task.queuedAt = detail::nowNs();
+#endif
+    // Incrementa contador de tareas en vuelo antes de publicarla, así wait()
+    // nunca puede observar cero con la tarea todavía pendiente. Recién después
+    // mira si el pool se está cerrando: el cierre hace lo inverso, así que o
+    // bien lo ve, o bien el cierre espera a esta tarea
+    ++tasksInFlight_;
+    if (!accepting_.load() && !admitDuringShutdown(&task, 1)) return;
+
+    // En modo WorkStealing, una tarea normal programada desde otra tarea va a
+    // la cola propia del trabajador, salvo que haya alguien dormido a quien
+    // entregársela
+    if (mode_ == SchedulingMode::WorkStealing && currentPool == this &&
+        priority == Priority::Normal && idleCount_.load() == 0) {
+        worker_t& self = wts[currentWorker];
+        {
+            lock_guard<mutex> lk(self.localLock);
+            self.local.push_back(self.slab.allocate(move(task)));
+        }
+        // si alguien se durmió mientras encolábamos, despertarlo para que robe
+        atomic_thread_fence(memory_order_seq_cst);
+        if (idleCount_.load() > 0) wakeIdleWorkers(self.node);
+        return;
+    }
+
+    int node = callerNode();
+    if (idleCount_.load() > 0 && handOff(task, node)) return;
+    enqueue(move(task), priority, node);
+    // si alguien se durmió mientras encolábamos, despertarlo
+    atomic_thread_fence(memory_order_seq_cst);
+    // sin trabajadores vivos (mínimo 0) nadie más la va a ejecutar: crecer
+    // aunque la cola no llegue a spawnQueueDepth_
+    if (idleCount_.load() > 0) {
+        wakeIdleWorkers(node);
+    } else if (liveWorkers_.load() < maxThreads_ &&
+               (liveWorkers_.load() == 0 || queuedTasks() >= spawnQueueDepth_)) {
+        maybeGrow();
+    }
+}
+
+// Programa un lote de tareas con un solo incremento de tareas en vuelo, a lo
+// sumo una toma de cada lock, y despertando solo a tantos trabajadores como
+// tareas hayan quedado en las colas
+void ThreadPool::scheduleBatch(vector<Task>& tasks, Priority priority) {
+    for (const Task& task : tasks) {
+        if (!task) throw invalid_argument("Tarea vacía no permitida");
     }
+    if (tasks.empty()) return;
+#ifdef TP_METRICS
+    uint64_t now = detail::nowNs();
+    for (Task& task : tasks) task.queuedAt = now;
+#endif
+    tasksInFlight_ += tasks.size();
+    if (!accepting_.load() && !admitDuringShutdown(tasks.data(), tasks.size())) return;
+
+    // primero a los trabajadores dormidos, directamente
+    int node = callerNode();
+    size_t first = idleCount_.load() > 0 ? handOffBatch(tasks, node) : 0;
+    if (first == tasks.size()) return;
+    size_t queued = tasks.size() - first;
 
-    // Iniciar el hilo despachador
-    dt = thread(&ThreadPool::dispatcher, this);
+    if (mode_ == SchedulingMode::WorkStealing && currentPool == this &&
+        priority == Priority::Normal) {
+        worker_t& self = wts[currentWorker];
+        lock_guard<mutex> lk(self.localLock);
+        for (size_t i = first; i < tasks.size(); i++)
+            self.local.push_back(self.slab.allocate(move(tasks[i])));
+    } else {
+        enqueueBatch(tasks, first, priority, node);
+    }
+    // si alguien se durmió mientras encolábamos, despertarlo
+    atomic_thread_fence(memory_order_seq_cst);
+    size_t idle = idleCount_.load();
+    if (idle > 0) {
+        wakeIdleWorkers(node, min(queued, idle));
+    } else {
+        for (size_t k = 0; k < queued && liveWorkers_.load() < maxThreads_ &&
+                           (liveWorkers_.load() == 0 || queuedTasks() >= spawnQueueDepth_); k++) {
+            maybeGrow();
+        }
+    }
 }
 
-// Programa una tarea en la cola y notifica al despachador
-void ThreadPool::schedule(const function<void()>& thunk) {
-    if (!thunk) throw invalid_argument("Tarea vacía no permitida");
-    // Protege acceso a la cola de tareas y flag done
+// Encola tasks[first..] en la cola de su prioridad: en el buffer circular
+// mientras entren, y el resto en el desborde con una sola toma de queueLock_
+void ThreadPool::enqueueBatch(vector<Task>& tasks, size_t first, Priority priority, int node) {
+    lane_t& lane = laneOf(node, (int)priority);
+    size_t i = first;
+    if (lane.overflowSize.load() == 0) {
+        while (i < tasks.size() && lane.ring.try_push(move(tasks[i]))) i++;
+    }
+    if (i == tasks.size()) return;
+    lock_guard<mutex> lk(queueLock_);
+    for (; i < tasks.size(); i++) lane.overflow.push_back(overflowSlab_.allocate(move(tasks[i])));
+    lane.overflowSize.store(lane.overflow.size());
+}
+
+// Entrega las primeras tareas del lote a los trabajadores dormidos, con una
+// sola toma de idleLock_. Devuelve cuántas entregó
+size_t ThreadPool::handOffBatch(vector<Task>& tasks, int node) {
+    vector<int> chosen;
     {
-        lock_guard<mutex> lk(queueLock_);
-        if (done) throw runtime_error("No se pueden programar tareas: pool detenido");
-        taskQueue.push_back(thunk);
+        lock_guard<mutex> lk(idleLock_);
+        for (int id; chosen.size() < tasks.size() && (id = popIdleWorker(node)) >= 0;) {
+            wts[id].thunk = move(tasks[chosen.size()]);
+            chosen.push_back(id);
+        }
+    }
+    for (int id : chosen) wts[id].sem.signal();
+    return chosen.size();
+}
+
+// Cantidad de tareas esperando en las colas compartidas
+size_t ThreadPool::queuedTasks() const {
+    size_t count = 0;
+    for (size_t i = 0; i < numNodes_ * kNumPriorities; i++)
+        count += lanes_[i].ring.size() + lanes_[i].overflowSize.load();
+    return count;
+}
+
+// Nodo desde el que se programa: el del trabajador actual, o el de la CPU
+// en la que corre el hilo que llama
+int ThreadPool::callerNode() const {
+    if (numNodes_ == 1) return 0;
+    if (currentPool == this) return wts[currentWorker].node;
+#ifdef __linux__
+    int cpu = sched_getcpu();
+    if (cpu >= 0 && (size_t)cpu < cpuNode_.size() && cpuNode_[cpu] >= 0) return cpuNode_[cpu];
+#endif
+    return 0;
+}
+
+// Fija el hilo actual (el del trabajador id) a sus CPUs, si tiene
+void ThreadPool::pinWorker(int id) {
+#ifdef __linux__
+    if (wts[id].cpus.empty()) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : wts[id].cpus) if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)id;
+#endif
+}
+
+// Pool elástico: lanza un trabajador más si nadie está libre y queda lugar
+void ThreadPool::maybeGrow() {
+    lock_guard<mutex> lk(idleLock_);
+    if (done || freeSlots_.empty() || idleCount_.load() > 0) return;
+    int id = freeSlots_.back();
+    freeSlots_.pop_back();
+    // el hilo que ocupaba este lugar ya se retiró: solo falta unirlo
+    if (wts[id].ts.joinable()) wts[id].ts.join();
+    wts[id].ts = thread(&ThreadPool::worker, this, id);
+    ++liveWorkers_;
+}
+
+// Encola en el buffer circular de su prioridad; si está lleno (o ya hay tareas
+// desbordadas, para respetar el orden FIFO) usa el desborde protegido por queueLock_
+void ThreadPool::enqueue(Task&& task, Priority priority, int node) {
+    lane_t& lane = laneOf(node, (int)priority);
+    if (lane.overflowSize.load() == 0 && lane.ring.try_push(move(task))) return;
+    lock_guard<mutex> lk(queueLock_);
+    lane.overflow.push_back(overflowSlab_.allocate(move(task)));
+    lane.overflowSize.store(lane.overflow.size());
+}
+
+// Saca de la pila de dormidos al más reciente del nodo dado o, si no hay
+// ninguno de ese nodo, al más reciente de todos. Devuelve -1 si no hay
+// nadie dormido. Se llama con idleLock_ tomado
+int ThreadPool::popIdleWorker(int node) {
+    if (idleWorkers_.empty()) return -1;
+    size_t pos = idleWorkers_.size() - 1;
+    if (numNodes_ > 1) {
+        for (size_t k = idleWorkers_.size(); k-- > 0;) {
+            if (wts[idleWorkers_[k]].node == node) {
+                pos = k;
+                break;
+            }
+        }
     }
-    // Incrementa contador de tareas en vuelo
+    int id = idleWorkers_[pos];
+    idleWorkers_.erase(idleWorkers_.begin() + pos);
+    idleCount_.store(idleWorkers_.size());
+    wts[id].available = false;
+    return id;
+}
+
+// Entrega la tarea directamente a un trabajador dormido (de su nodo si es
+// posible). Devuelve false (sin tocar la tarea) si no quedaba ninguno; en un
+// pool elástico, el que se anotó pudo haberse retirado: lanzar otro
+bool ThreadPool::handOff(Task& task, int node) {
+    int id = -1;
     {
-        lock_guard<mutex> lk(waitLock_);
-        ++tasksInFlight_;
+        lock_guard<mutex> lk(idleLock_);
+        id = popIdleWorker(node);
+        if (id >= 0) wts[id].thunk = move(task);
+    }
+    if (id < 0) {
+        if (liveWorkers_.load() < maxThreads_) maybeGrow();
+        return false;
+    }
+    wts[id].sem.signal(); // despertar al trabajador elegido
+    return true;
+}
+
+// Despierta hasta count trabajadores dormidos (de a uno sin reservar memoria)
+// sin entregarles tarea, para que la busquen en las colas. Si no encuentra a
+// nadie (los que se anotaron se retiraron), en un pool elástico lanza otro
+void ThreadPool::wakeIdleWorkers(int node, size_t count) {
+    if (count == 1) {
+        int id = -1;
+        {
+            lock_guard<mutex> lk(idleLock_);
+            id = popIdleWorker(node);
+        }
+        if (id >= 0) wts[id].sem.signal();
+        else if (liveWorkers_.load() < maxThreads_) maybeGrow();
+        return;
+    }
+    vector<int> chosen;
+    {
+        lock_guard<mutex> lk(idleLock_);
+        for (int id; chosen.size() < count && (id = popIdleWorker(node)) >= 0;) chosen.push_back(id);
     }
-    queueCv_.notify_one(); // señalizar al despachador
+    for (int id : chosen) wts[id].sem.signal();
+    if (chosen.empty() && liveWorkers_.load() < maxThreads_) maybeGrow();
 }
 
-// Hilo despachador: espera tareas y las asigna a trabajadores disponibles
-void ThreadPool::dispatcher() {
-   while (true) {
-        function<void(void)> task;
+// Roba la tarea más antigua de la cola de algún otro trabajador, del mismo
+// nodo (sameNode) o de los demás. El nodo vuelve al slab de la víctima, del
+// que salió, para que ningún slab crezca sin límite
+bool ThreadPool::stealTask(int id, bool sameNode, Task& fn) {
+    for (size_t k = 1; k < wts.size(); ++k) {
+        worker_t& victim = wts[(id + k) % wts.size()];
+        if ((victim.node == wts[id].node) != sameNode) continue;
+        bool stolen = false;
         {
-            unique_lock<mutex> lk(queueLock_);
-            queueCv_.wait(lk, [this]{ return done || !taskQueue.empty(); });
-            if (done && taskQueue.empty()) break;
-            task = move(taskQueue.front());
-            taskQueue.pop_front();
-        }
-        // Buscar un trabajador disponible
-        bool assigned = false;
-        while (!assigned) {
-            if (done) break;
-            for (size_t i = 0; i < wts.size(); ++i) {
-                lock_guard<mutex> lk(wts[i].mtx);
-                if (wts[i].available) {
-                    wts[i].available = false;
-                    wts[i].thunk = move(task);
-                    wts[i].sem.signal();
-                    assigned = true;
-                    break;
-                }
+            lock_guard<mutex> lk(victim.localLock);
+            if (!victim.local.empty()) {
+                TaskNode *node = victim.local.pop_front();
+                fn = move(node->task);
+                victim.slab.free(node);
+                stolen = true;
+            }
+        }
+        if (stolen) {
+#ifdef TP_METRICS
+            detail::bump(wts[id].stats.steals);
+#endif
+            return true;
+        }
+    }
+    return false;
+}
+
+// Indica si queda alguna tarea encolada en cualquier lugar del pool
+bool ThreadPool::hasPendingWork() {
+    for (size_t i = 0; i < numNodes_ * kNumPriorities; i++) {
+        if (!lanes_[i].ring.empty() || lanes_[i].overflowSize.load() > 0) return true;
+    }
+    if (mode_ != SchedulingMode::WorkStealing) return false;
+    for (auto& w : wts) {
+        lock_guard<mutex> lk(w.localLock);
+        if (!w.local.empty()) return true;
+    }
+    return false;
+}
+
+// Saca la tarea más antigua de la cola de una prioridad de un nodo
+bool ThreadPool::popLane(int node, int lane, Task& fn) {
+    lane_t& l = laneOf(node, lane);
+    if (l.ring.try_pop(fn)) return true;
+    if (l.overflowSize.load() == 0) return false;
+    lock_guard<mutex> lk(queueLock_);
+    if (l.overflow.empty()) return false;
+    TaskNode *head = l.overflow.pop_front();
+    l.overflowSize.store(l.overflow.size());
+    fn = move(head->task);
+    overflowSlab_.free(head);
+    return true;
+}
+
+// Busca la próxima tarea: primero la cola High del nodo, luego la propia (la
+// más reciente), después Normal y Low del nodo, robando a los trabajadores
+// del nodo, y recién entonces en las colas y trabajadores de otros nodos.
+// Cada kNormalEvery / kLowEvery búsquedas se empieza por Normal / Low para
+// que las prioridades bajas no esperen indefinidamente
+bool ThreadPool::popTask(int id, Task& fn) {
+    unsigned pick = wts[id].picks++;
+    int home = wts[id].node;
+    int first = (int)Priority::High;
+    if (pick % kLowEvery == kLowEvery - 1) first = (int)Priority::Low;
+    else if (pick % kNormalEvery == kNormalEvery - 1) first = (int)Priority::Normal;
+    if (first != (int)Priority::High && popLane(home, first, fn)) return true;
+
+    if (popLane(home, (int)Priority::High, fn)) return true;
+    if (mode_ == SchedulingMode::WorkStealing) {
+        lock_guard<mutex> lk(wts[id].localLock);
+        if (!wts[id].local.empty()) {
+            TaskNode *node = wts[id].local.pop_back();
+            fn = move(node->task);
+            wts[id].slab.free(node);
+            return true;
+        }
+    }
+    for (int lane = (int)Priority::Normal; lane < kNumPriorities; lane++) {
+        if (lane != first && popLane(home, lane, fn)) return true;
+    }
+    if (mode_ == SchedulingMode::WorkStealing && stealTask(id, true, fn)) return true;
+    for (size_t k = 1; k < numNodes_; k++) {
+        for (int lane = 0; lane < kNumPriorities; lane++) {
+            if (popLane((int)((home + k) % numNodes_), lane, fn)) return true;
+        }
+    }
+    return mode_ == SchedulingMode::WorkStealing && numNodes_ > 1 && stealTask(id, false, fn);
+}
+
+// Tareas programadas (ya contadas en vuelo) mientras el pool se cierra. Las
+// que programan sus propias tareas se aceptan mientras se vacía (Drain) y se
+// apartan para devolverlas en un cierre con CancelPending; las de afuera se
+// rechazan. Devuelve true si hay que encolarlas
+bool ThreadPool::admitDuringShutdown(Task *tasks, size_t count) {
+    bool inside = currentPool == this;
+    if (inside && !cancelling_.load()) return true;
+    if (inside) {
+        lock_guard<mutex> lk(setAsideLock_);
+        for (size_t i = 0; i < count; i++) setAside_.push_back(move(tasks[i]));
+    }
+    taskDone(count);
+    if (!inside) throw runtime_error("No se pueden programar tareas: pool detenido");
+    return false;
+}
+
+// Descuenta tareas terminadas (o descartadas) y despierta a quienes esperan
+// en wait()
+void ThreadPool::taskDone(size_t count) {
+    if ((tasksInFlight_ -= count) == 0) {
+        lock_guard<mutex> lk(waitLock_);
+        waitCv_.notify_all();
+    }
+}
+
+// Ejecuta una tarea pendiente en el hilo actual (que debe ser un trabajador
+// de este pool). Devuelve false si no encontró ninguna
+bool ThreadPool::runPendingTask() {
+    Task fn;
+    if (!popTask(currentWorker, fn)) return false;
+    runTask(currentWorker, fn);
+    return true;
+}
+
+// Ejecuta una tarea en el trabajador id y la descuenta de las tareas en vuelo.
+// Con TP_METRICS además mide su espera en la cola y su duración; el tiempo
+// ocupado solo se suma en la tarea más externa, para no contar dos veces las
+// que se ejecutan mientras otra tarea ayuda en una espera
+void ThreadPool::runTask(int id, Task& fn) {
+#ifdef TP_METRICS
+    WorkerStats& st = wts[id].stats;
+    bool outer = !st.running;
+    st.running = true;
+    uint64_t start = detail::nowNs();
+    fn();
+    uint64_t end = detail::nowNs();
+    st.running = !outer;
+    uint64_t waited = start > fn.queuedAt ? start - fn.queuedAt : 0;
+    detail::bump(st.tasksRun);
+    detail::bump(st.waitHist[LatencyHistogram::bucketFor(waited)]);
+    detail::bump(st.runHist[LatencyHistogram::bucketFor(end - start)]);
+    if (outer) detail::bump(st.busyNs, end - start);
+    if (tracing_.load(memory_order_relaxed)) {
+        lock_guard<mutex> lk(st.traceLock);
+        st.trace.push_back(TraceEvent{start, end - start, waited});
+    }
+#else
+    (void)id;
+    fn();
+#endif
+    taskDone();
+}
+
+// Espera en el semáforo del trabajador. En un pool elástico la espera vence
+// a los idleTimeout_ (devuelve false) para que el trabajador pueda retirarse
+bool ThreadPool::waitWakeup(int id) {
+    if (minThreads_ == maxThreads_) {
+        wts[id].sem.wait();
+        return true;
+    }
+    return wts[id].sem.wait_for(idleTimeout_);
+}
+
+// Se anota como disponible y duerme hasta que le entreguen una tarea (que
+// deja en fn) o lo despierten para que la busque. Devuelve false si el
+// trabajador tiene que terminar, por cierre del pool o porque se retira
+bool ThreadPool::park(int id, Task& fn) {
+    unique_lock<mutex> lk(idleLock_);
+    if (done) return false;
+    wts[id].available = true;
+    idleWorkers_.push_back(id);
+    idleCount_.store(idleWorkers_.size());
+    lk.unlock();
+    // alguien pudo haber encolado justo antes de ver que nos anotamos:
+    // si es así, salir de la pila y volver a buscar
+    atomic_thread_fence(memory_order_seq_cst);
+    if (hasPendingWork()) {
+        lk.lock();
+        if (wts[id].available) {
+            idleWorkers_.erase(find(idleWorkers_.begin(), idleWorkers_.end(), id));
+            idleCount_.store(idleWorkers_.size());
+            wts[id].available = false;
+            return true;
+        }
+        lk.unlock(); // ya nos eligieron: la señal está en camino
+    }
+    while (!waitWakeup(id)) {
+        lk.lock();
+        if (!wts[id].available) {
+            // nos eligieron justo al vencer la espera: la señal está en camino
+            lk.unlock();
+            wts[id].sem.wait();
+            break;
+        }
+        if (liveWorkers_.load() > minThreads_) {
+            // inactivo demasiado tiempo: retirarse y liberar el lugar
+            idleWorkers_.erase(find(idleWorkers_.begin(), idleWorkers_.end(), id));
+            idleCount_.store(idleWorkers_.size());
+            wts[id].available = false;
+            --liveWorkers_;
+            // quien encoló justo antes de ver que nos fuimos no lanzó a
+            // nadie (nos creyó dormidos o vivos): si hay trabajo, quedarse
+            atomic_thread_fence(memory_order_seq_cst);
+            if (hasPendingWork()) {
+                ++liveWorkers_;
+                return true;
             }
-            if (!assigned) this_thread::yield();
+            freeSlots_.push_back(id);
+            return false;
         }
+        lk.unlock();
     }
+    // quien nos despertó ya nos sacó de idleWorkers_
+    fn = move(wts[id].thunk);
+    return true;
 }
 
-// Función que ejecuta cada trabajador
+// Función que ejecuta cada trabajador: toma tareas mientras haya, y cuando no
+// encuentra ninguna se anota como disponible y duerme en su semáforo
 void ThreadPool::worker(int id) {
-  while (true) {
-        wts[id].sem.wait(); // esperar señal de nueva tarea o cierre
-        function<void(void)> fn;
-        {
-            lock_guard<mutex> lk(wts[id].mtx);
-            if (done && !wts[id].thunk) break;
-            fn = move(wts[id].thunk);
+    currentPool = this;
+    currentWorker = id;
+    pinWorker(id);
+    while (true) {
+        Task fn;
+        if (!popTask(id, fn)) {
+#ifdef TP_METRICS
+            uint64_t idleSince = detail::nowNs();
+            bool working = park(id, fn);
+            detail::bump(wts[id].stats.idleNs, detail::nowNs() - idleSince);
+            if (!working) break;
+            if (fn) detail::bump(wts[id].stats.handoffs);
+#else
+            if (!park(id, fn)) break;
+#endif
+            if (!fn) continue; // sin tarea: volver a buscar y revisar done
         }
-        if (fn) fn();
-        {
-            lock_guard<mutex> lk(waitLock_);
-            if (--tasksInFlight_ == 0) waitCv_.notify_all();
+        runTask(id, fn);
+    }
+    currentPool = nullptr;
+    currentWorker = -1;
+}
+
+// Foto de los contadores. La profundidad de cola se calcula siempre; el resto
+// solo existe con TP_METRICS
+PoolMetrics ThreadPool::metrics() const {
+    PoolMetrics m;
+    m.queueDepth = queuedTasks();
+    if (mode_ == SchedulingMode::WorkStealing) {
+        for (auto& w : wts) {
+            lock_guard<mutex> lk(w.localLock);
+            m.queueDepth += w.local.size();
         }
-        {
-            lock_guard<mutex> lk(wts[id].mtx);
-            wts[id].available = true;
+    }
+#ifdef TP_METRICS
+    m.enabled = true;
+    for (auto& w : wts) {
+        const WorkerStats& st = w.stats;
+        WorkerMetrics wm;
+        wm.tasksRun = st.tasksRun.load(memory_order_relaxed);
+        wm.busyNs = st.busyNs.load(memory_order_relaxed);
+        wm.idleNs = st.idleNs.load(memory_order_relaxed);
+        wm.steals = st.steals.load(memory_order_relaxed);
+        wm.handoffs = st.handoffs.load(memory_order_relaxed);
+        m.workers.push_back(wm);
+        for (int b = 0; b < LatencyHistogram::kBuckets; b++) {
+            m.queueWait.buckets[b] += st.waitHist[b].load(memory_order_relaxed);
+            m.runTime.buckets[b] += st.runHist[b].load(memory_order_relaxed);
         }
     }
+#endif
+    return m;
+}
+
+void ThreadPool::startTrace() {
+#ifdef TP_METRICS
+    for (auto& w : wts) {
+        lock_guard<mutex> lk(w.stats.traceLock);
+        w.stats.trace.clear();
+    }
+    traceEpoch_.store(detail::nowNs());
+    tracing_.store(true);
+#endif
+}
+
+void ThreadPool::stopTrace() {
+#ifdef TP_METRICS
+    tracing_.store(false);
+#endif
+}
+
+#ifdef TP_METRICS
+// Escribe ns como microsegundos con tres decimales (sin notación científica)
+static void writeMicros(ostream& out, uint64_t ns) {
+    uint64_t frac = ns % 1000;
+    out << ns / 1000 << '.' << (char)('0' + frac / 100) << (char)('0' + frac / 10 % 10)
+        << (char)('0' + frac % 10);
+}
+#endif
+
+// Escribe los eventos en el formato JSON de Chrome trace: un evento completo
+// ("ph":"X") por tarea, con tiempos en microsegundos y un hilo por trabajador
+void ThreadPool::writeTrace(ostream& out) const {
+    out << "{\"traceEvents\":[";
+#ifdef TP_METRICS
+    const char *sep = "";
+    uint64_t epoch = traceEpoch_.load();
+    for (size_t id = 0; id < wts.size(); id++) {
+        lock_guard<mutex> lk(wts[id].stats.traceLock);
+        for (const TraceEvent& ev : wts[id].stats.trace) {
+            uint64_t start = ev.startNs > epoch ? ev.startNs - epoch : 0;
+            out << sep << "\n{\"name\":\"task\",\"ph\":\"X\",\"pid\":0,\"tid\":" << id
+                << ",\"ts\":";
+            writeMicros(out, start);
+            out << ",\"dur\":";
+            writeMicros(out, ev.runNs);
+            out << ",\"args\":{\"wait_us\":";
+            writeMicros(out, ev.waitNs);
+            out << "}}";
+            sep = ",";
+        }
+    }
+#endif
+    out << "\n]}\n";
+}
+
+// Marca la tarea como terminada y despierta a quienes esperan su resultado
+void TaskStateBase::markReady() {
+    ready_.store(true);
+    if (waiters_.load() > 0) {
+        lock_guard<mutex> lk(mtx_);
+        cv_.notify_all();
+    }
+}
+
+// Espera a que la tarea termine. Un trabajador del mismo pool no se duerme:
+// ejecuta otras tareas pendientes (quizás la que espera) mientras tanto, y
+// solo si no encuentra ninguna espera un momento antes de volver a buscar
+void TaskStateBase::wait() {
+    bool helping = pool_ != nullptr && currentPool == pool_;
+    while (!ready()) {
+        if (helping && pool_->runPendingTask()) continue;
+        unique_lock<mutex> lk(mtx_);
+        ++waiters_;
+        if (helping) {
+            cv_.wait_for(lk, chrono::milliseconds(1), [this]{ return ready(); });
+        } else {
+            cv_.wait(lk, [this]{ return ready(); });
+        }
+        --waiters_;
+    }
+}
+
+// Descuenta una tarea del grupo y despierta a quienes esperan al grupo.
+// finishing_ le indica a wait() que todavía hay alguien usando el grupo,
+// para que no vuelva (y el grupo se destruya) antes de que terminemos
+void TaskGroup::finish() {
+    ++finishing_;
+    if (--pending_ == 0 && waiters_.load() > 0) {
+        lock_guard<mutex> lk(mtx_);
+        cv_.notify_all();
+    }
+    --finishing_;
+}
+
+// Espera solo a las tareas del grupo, ayudando si se llama desde el pool
+void TaskGroup::wait() {
+    bool helping = currentPool == &pool_;
+    while (pending_.load() > 0) {
+        if (helping && pool_.runPendingTask()) continue;
+        unique_lock<mutex> lk(mtx_);
+        ++waiters_;
+        if (helping) {
+            cv_.wait_for(lk, chrono::milliseconds(1), [this]{ return pending_.load() == 0; });
+        } else {
+            cv_.wait(lk, [this]{ return pending_.load() == 0; });
+        }
+        --waiters_;
+    }
+    while (finishing_.load() > 0) this_thread::yield();
 }
 
 // Bloquea hasta que todas las tareas en vuelo finalicen
@@ -94,20 +768,85 @@ void ThreadPool::wait() {
     waitCv_.wait(lk, [this]{ return tasksInFlight_ == 0; });
 }
 
+// Saca de las colas todas las tareas que todavía no empezaron (en orden de
+// cola) y las agrega a out. Las que ya se entregaron a un trabajador siguen
+void ThreadPool::drainQueues(vector<Task>& out) {
+    lock_guard<mutex> lk(queueLock_);
+    for (size_t i = 0; i < numNodes_ * kNumPriorities; i++) {
+        lane_t& lane = lanes_[i];
+        Task task;
+        while (lane.ring.try_pop(task)) out.push_back(move(task));
+        while (!lane.overflow.empty()) {
+            TaskNode *head = lane.overflow.pop_front();
+            out.push_back(move(head->task));
+            overflowSlab_.free(head);
+        }
+        lane.overflowSize.store(0);
+    }
+    for (auto &w : wts) {
+        lock_guard<mutex> lk2(w.localLock);
+        while (!w.local.empty()) {
+            TaskNode *head = w.local.pop_front();
+            out.push_back(move(head->task));
+            w.slab.free(head);
+        }
+    }
+}
+
+// Cierra el pool: deja de aceptar tareas desde afuera y, según el modo,
+// espera a las pendientes o las saca de las colas para devolverlas
+vector<Task> ThreadPool::shutdown(ShutdownMode mode) {
+    if (currentPool == this) throw logic_error("No se puede cerrar el pool desde una de sus tareas");
+    lock_guard<mutex> lk(shutdownLock_);
+    vector<Task> cancelled;
+    if (mode == ShutdownMode::CancelPending) {
+        // cancelling_ antes que accepting_: quien vea el pool cerrado ya sabe
+        // que sus tareas se apartan
+        cancelling_.store(true);
+        accepting_.store(false);
+        drainQueues(cancelled);
+        if (!cancelled.empty()) taskDone(cancelled.size());
+    } else {
+        accepting_.store(false);
+    }
+    wait();
+    stopWorkers();
+    lock_guard<mutex> lk2(setAsideLock_);
+    for (Task& task : setAside_) cancelled.push_back(move(task));
+    setAside_.clear();
+    return cancelled;
+}
+
+// Como shutdown(Drain), pero se rinde si las tareas no terminan a tiempo
+bool ThreadPool::try_shutdown_for(chrono::milliseconds timeout) {
+    if (currentPool == this) throw logic_error("No se puede cerrar el pool desde una de sus tareas");
+    lock_guard<mutex> lk(shutdownLock_);
+    accepting_.store(false);
+    {
+        unique_lock<mutex> wl(waitLock_);
+        if (!waitCv_.wait_for(wl, timeout, [this]{ return tasksInFlight_ == 0; })) return false;
+    }
+    stopWorkers();
+    return true;
+}
+
 // Destructor: espera la finalización de tareas y cierra el pool
 ThreadPool::~ThreadPool() {
-    // 1) Esperar a que todas las tareas en vuelo terminen
-    wait();
-    // 2) Indicar cierre al despachador
+    shutdown(ShutdownMode::Drain);
+}
+
+// Detiene a los trabajadores (sin tareas en vuelo). Llamarla de nuevo no hace nada
+void ThreadPool::stopWorkers() {
+    // 1) Indicar cierre y despertar a los trabajadores dormidos
+    vector<int> sleeping;
     {
-        lock_guard<mutex> lk(queueLock_);
+        lock_guard<mutex> lk(idleLock_);
         done = true;
+        sleeping.swap(idleWorkers_);
+        idleCount_.store(0);
+        for (int id : sleeping) wts[id].available = false;
     }
-    queueCv_.notify_one();
-    // 3) Esperar a que el hilo despachador termine
-    if (dt.joinable()) dt.join();
-    // 4) Señalizar a todos los trabajadores para que salgan
-    for (auto &w : wts) w.sem.signal();
-    // 5) Unir hilos trabajadores
+    for (int id : sleeping) wts[id].sem.signal();
+    // 2) Unir hilos trabajadores
     for (auto &w : wts) if (w.ts.joinable()) w.ts.join();
-}
\ No newline at end of file
+}
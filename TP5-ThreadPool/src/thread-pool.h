@@ -3,8 +3,10 @@
  * -------------------
  * This class defines the ThreadPool class, which accepts a collection
  * of thunks (which are zero-argument functions that don't return a value)
- * and schedules them in a FIFO manner to be executed by a constant number
- * of child threads that exist solely to invoke previously scheduled thunks.
+ * and schedules them in a FIFO manner (within each priority class) to be
+ * executed by a constant number of child threads (or, for an elastic pool,
+ * a number that follows the load between a minimum and a maximum) that
+ * exist solely to invoke previously scheduled thunks.
  */
 
 #ifndef _thread_pool_
@@ -12,14 +14,21 @@
 
 #include <cstddef>     // for size_t
 #include <functional>  // for the function template used in the schedule signature
+#include <memory>      // for unique_ptr
+#include <ostream>     // for ostream
 #include <thread>      // for thread
 #include <vector>      // for vector
 #include "Semaphore.h" // for Semaphore
+#include "mpmc-queue.h" // for MPMCQueue
+#include "task-future.h" // for TaskFuture
+#include "task.h"       // for Task, TaskSlab, TaskDeque
+#include "pool-metrics.h" // for PoolMetrics
 
 #include <stdexcept>            // std::runtime_error
 #include <deque>
 #include <condition_variable>  // for condition_variable
 #include <atomic>      
+#include <chrono>              // for milliseconds
 
 using namespace std;
 
@@ -28,35 +37,177 @@ using namespace std;
  * @brief Represents a worker in the thread pool.
  * 
  * The `worker_t` struct contains information about a worker 
- * thread in the thread pool. Should be includes the thread object, 
- * availability status, the task to be executed, and a semaphore 
- * (or condition variable) to signal when work is ready for the 
- * worker to process.
+ * thread in the thread pool. It includes the thread object, 
+ * availability status, the task handed off to it while it was
+ * parked, and a semaphore to wake it up when that task is ready
+ * (or when the pool shuts down).
  */
 typedef struct worker { 
     thread              ts;        // hilo del trabajador
-    function<void(void)> thunk;    // tarea asignada al trabajador
+    Task                thunk;     // tarea entregada directamente mientras estaba dormido
     Semaphore           sem{0};    // semáforo para señal de nueva tarea o cierre
-    mutex               mtx;       // mutex para proteger acceso a thunk y available
-    bool                available; // indica si está libre para recibir tareas
+    bool                available; // indica si está dormido esperando tareas (protegido por idleLock_)
+
+    TaskDeque           local;     // cola propia (solo en modo WorkStealing)
+    mutable mutex       localLock; // protege local y slab
+    TaskSlab            slab;      // nodos de local (protegido por localLock)
+    unsigned            picks = 0; // búsquedas de tareas hechas (para no postergar prioridades bajas)
+    int                 node = 0;  // nodo NUMA al que pertenece (0 sin Placement::numa)
+    vector<int>         cpus;      // CPUs a las que se fija el hilo (vacío: sin fijar)
+#ifdef TP_METRICS
+    WorkerStats         stats;     // contadores del lugar (solo con TP_METRICS)
+#endif
 } worker_t;
 
+/**
+ * @brief How scheduled thunks are distributed among the workers.
+ *
+ * - Shared: every thunk goes through the single shared FIFO queue.
+ * - WorkStealing: thunks scheduled from inside a running thunk go to the
+ *   calling worker's own deque (newest first for the owner), and idle
+ *   workers steal the oldest entries from other workers' deques. Thunks
+ *   scheduled from outside the pool still go through the shared queue.
+ */
+enum class SchedulingMode { Shared, WorkStealing };
+
+/**
+ * @brief Priority class of a scheduled thunk.
+ *
+ * Each class has its own FIFO lane and workers prefer higher classes, but
+ * every few picks a worker starts from a lower lane instead, so a steady
+ * stream of High thunks cannot starve Normal or Low ones.
+ */
+enum class Priority { High, Normal, Low };
+
+/**
+ * @brief Sizing policy of an elastic ThreadPool.
+ *
+ * The pool starts minThreads workers. When a thunk is queued while no
+ * worker is idle and at least spawnQueueDepth thunks are waiting in the
+ * shared queue, a new worker is started (up to maxThreads). If no worker is
+ * alive at all (minThreads may be 0), any queued thunk starts one. A worker
+ * that stays idle for idleTimeout exits, as long as more than minThreads
+ * remain and no thunk is waiting to run.
+ */
+struct ElasticConfig {
+    ElasticConfig(size_t minThreads, size_t maxThreads)
+        : minThreads(minThreads), maxThreads(maxThreads) {}
+
+    size_t               minThreads;
+    size_t               maxThreads;
+    chrono::milliseconds idleTimeout{1000};
+    size_t               spawnQueueDepth{1};
+};
+
+/**
+ * @brief Where the worker threads run.
+ *
+ * - cpuSets: worker i is pinned to the CPUs listed in
+ *   cpuSets[i % cpuSets.size()]. Empty leaves the workers free to migrate.
+ * - numa: the workers are spread evenly over the NUMA nodes, each pinned to
+ *   its node's CPUs (unless cpuSets says otherwise), and every node gets its
+ *   own queues. Thunks scheduled from a node are queued on that node and
+ *   handed to that node's idle workers first; workers of other nodes only
+ *   take them once their own node's queues are empty.
+ * - numaNodes: the CPUs of each node; left empty, they are read from
+ *   /sys/devices/system/node (a single node if that is not available).
+ *
+ * Pinning is best effort: a CPU the process is not allowed to use is
+ * ignored by the kernel's affinity call rather than reported.
+ */
+struct Placement {
+    vector<vector<int>> cpuSets;
+    bool                numa = false;
+    vector<vector<int>> numaNodes;
+
+  /**
+  * One CPU per worker, taken in order (and round-robin) from the CPUs the
+  * process may run on.
+  */
+    static Placement pinToCores();
+
+  /**
+  * Node-local queues on the machine's NUMA nodes, each worker pinned to
+  * its node.
+  */
+    static Placement numaAware();
+};
+
+/**
+ * @brief What ThreadPool::shutdown does with the thunks that have not
+ * started yet.
+ *
+ * - Drain: runs them all (and whatever they schedule) before stopping.
+ * - CancelPending: takes them out of the queues and hands them back to the
+ *   caller instead. Thunks that running thunks schedule while the pool is
+ *   shutting down are handed back too.
+ */
+enum class ShutdownMode { Drain, CancelPending };
+
 class ThreadPool {
   public:
 
   /**
   * Constructs a ThreadPool configured to spawn up to the specified
-  * number of threads.
+  * number of threads, distributing work according to the given mode.
   */
-    ThreadPool(size_t numThreads);
+    ThreadPool(size_t numThreads, SchedulingMode mode = SchedulingMode::Shared,
+               const Placement& placement = Placement());
+
+  /**
+  * Constructs an elastic ThreadPool whose number of threads grows and
+  * shrinks with the load according to config.
+  */
+    ThreadPool(const ElasticConfig& config, SchedulingMode mode = SchedulingMode::Shared,
+               const Placement& placement = Placement());
 
   /**
   * Schedules the provided thunk (which is something that can
   * be invoked as a zero-argument function without a return value)
   * to be executed by one of the ThreadPool's threads as soon as
-  * all previously scheduled thunks have been handled.
+  * all previously scheduled thunks of the same priority have been
+  * handled.
+  */
+    void schedule(const function<void(void)>& thunk, Priority priority = Priority::Normal);
+
+  /**
+  * Same as above for any zero-argument callable, which is moved (never
+  * copied) into the queue. Callables up to Task::kInlineSize bytes are
+  * stored without any heap allocation.
+  */
+    template <typename F>
+    void schedule(F&& thunk, Priority priority = Priority::Normal) {
+        scheduleTask(Task(forward<F>(thunk)), priority);
+    }
+
+  /**
+  * Schedules every thunk of the given range (a vector of functions, an
+  * array of lambdas, ...) as if schedule() were called on each in order,
+  * but counting, queueing and waking workers once for the whole batch: at
+  * most one acquisition of each lock and only as many wake-ups as there
+  * are thunks left in the queues. The thunks are moved out of the range
+  * when it is passed as an rvalue and copied otherwise. If any thunk is
+  * empty, nothing is scheduled.
+  */
+    template <typename Range>
+    void schedule_bulk(Range&& thunks, Priority priority = Priority::Normal);
+
+  /**
+  * Schedules indexFn(i) for every i in [0, count) as one batch, like
+  * schedule_bulk. indexFn is stored once and shared by all the thunks.
+  */
+    template <typename F>
+    void schedule_n(size_t count, F&& indexFn, Priority priority = Priority::Normal);
+
+  /**
+  * Schedules fn(args...) like schedule() does and returns a handle to its
+  * result (or to the exception it throws). The callable, the arguments and
+  * the result share one allocation; no std::packaged_task is involved.
   */
-    void schedule(const function<void(void)>& thunk);
+    template <typename F, typename... Args>
+    TaskFuture<typename decay<decltype(declval<typename decay<F>::type>()(
+        declval<typename decay<Args>::type>()...))>::type>
+    submit(F&& fn, Args&&... args);
 
   /**
   * Blocks and waits until all previously scheduled thunks
@@ -64,35 +215,152 @@ class ThreadPool {
   */
     void wait();
 
+  /**
+  * Returns the number of worker threads currently running.
+  */
+    size_t size() const { return liveWorkers_.load(); }
+
+  /**
+  * Returns the maximum number of worker threads (equal to size() unless
+  * the pool is elastic).
+  */
+    size_t maxSize() const { return maxThreads_; }
+
+  /**
+  * Returns the number of NUMA nodes with their own queues (1 unless the
+  * pool was built with Placement::numa).
+  */
+    size_t numaNodes() const { return numNodes_; }
+
+  /**
+  * Returns a snapshot of the pool's counters: queue depth always, and when
+  * compiled with -DTP_METRICS also queue-wait and run-time histograms and
+  * per-worker task, busy/idle, steal and handoff counts.
+  */
+    PoolMetrics metrics() const;
+
+  /**
+  * Starts (discarding earlier events) or stops recording the start and end
+  * of every task for writeTrace(). They do nothing without TP_METRICS.
+  */
+    void startTrace();
+    void stopTrace();
+
+  /**
+  * Writes the recorded task events as Chrome trace JSON (loadable in
+  * chrome://tracing or Perfetto), one track per worker. Without TP_METRICS
+  * the event list is empty.
+  */
+    void writeTrace(ostream& out) const;
+
+  /**
+  * Stops the pool: from then on schedule() from outside the pool throws
+  * runtime_error. Waits for the thunks already running (and, with Drain,
+  * for the queued ones), stops the workers and returns the thunks that were
+  * cancelled, in queue order, so the caller can run them elsewhere or just
+  * drop them. Dropping a cancelled thunk completes its TaskFuture with
+  * future_error(broken_promise) and counts it as finished in its TaskGroup.
+  * Calling it again (or after a successful try_shutdown_for) does nothing.
+  * Must not be called from one of the pool's own thunks.
+  */
+    vector<Task> shutdown(ShutdownMode mode = ShutdownMode::Drain);
+
+  /**
+  * Like shutdown(Drain) but waits at most timeout for the pool to drain.
+  * Returns true if the pool stopped; otherwise returns false leaving the
+  * pool draining (still not accepting thunks from outside), so the caller
+  * can try again or fall back to shutdown(CancelPending).
+  */
+    bool try_shutdown_for(chrono::milliseconds timeout);
+
   /**
   * Waits for all previously scheduled thunks to execute, and then
   * properly brings down the ThreadPool and any resources tapped
-  * over the course of its lifetime.
+  * over the course of its lifetime (same as shutdown(Drain)).
   */
     ~ThreadPool();
 
   private:
 
+    friend class TaskStateBase; // para ayudar a ejecutar tareas mientras espera
+    friend class TaskGroup;
+
     void worker(int id); 
-    void dispatcher();  
+    bool park(int id, Task& fn);
+    bool waitWakeup(int id);
+    void maybeGrow();
+    size_t queuedTasks() const;
+    bool runPendingTask();
+    void runTask(int id, Task& fn);
+    void scheduleTask(Task&& task, Priority priority);
+    bool admitDuringShutdown(Task *tasks, size_t count);
+    void drainQueues(vector<Task>& out);
+    void stopWorkers();
+    void scheduleBatch(vector<Task>& tasks, Priority priority);
+    void enqueueBatch(vector<Task>& tasks, size_t first, Priority priority, int node);
+    size_t handOffBatch(vector<Task>& tasks, int node);
+    void enqueue(Task&& task, Priority priority, int node);
+    bool handOff(Task& task, int node);
+    int popIdleWorker(int node);
+    int callerNode() const;
+    void pinWorker(int id);
+    bool popTask(int id, Task& fn);
+    bool popLane(int node, int lane, Task& fn);
+    bool stealTask(int id, bool sameNode, Task& fn);
+    bool hasPendingWork();
+    void wakeIdleWorkers(int node, size_t count = 1);
+    void taskDone(size_t count = 1);
+
+    static const size_t           kLaneCapacity = 2048; // capacidad de cada cola sin locks
+    static const int              kNumPriorities = 3;   // High, Normal, Low
+    static const unsigned         kNormalEvery = 4;     // cada cuántas búsquedas se empieza por Normal
+    static const unsigned         kLowEvery = 16;       // cada cuántas búsquedas se empieza por Low
 
-    thread                        dt;         // hilo despachador
-    vector<worker_t>              wts;        // vector de trabajadores
+    // Cola FIFO de una prioridad: buffer circular sin locks más desborde
+    struct lane_t {
+        lane_t() : ring(kLaneCapacity) {}
+        MPMCQueue<Task>   ring;              // tareas pendientes (sin locks)
+        TaskDeque         overflow;          // tareas que no entraron en ring
+        atomic<size_t>    overflowSize{0};   // tamaño de overflow, legible sin queueLock_
+    };
 
-    deque<function<void(void)>>  taskQueue; // cola de tareas pendientes
-    mutex                         queueLock_; // protege la cola de tareas
-    condition_variable            queueCv_;   // notifica al despachador de nuevas tareas o cierre
+    const SchedulingMode          mode_;      // política de reparto de tareas
+    const size_t                  minThreads_; // trabajadores que nunca se retiran
+    const size_t                  maxThreads_; // máximo de trabajadores vivos
+    const chrono::milliseconds    idleTimeout_; // inactividad tras la cual se retira un trabajador
+    const size_t                  spawnQueueDepth_; // tareas encoladas que justifican un trabajador más
+    vector<worker_t>              wts;        // lugares para maxThreads_ trabajadores
+    vector<int>                   freeSlots_; // lugares de wts sin hilo vivo (protegido por idleLock_)
+    atomic<size_t>                liveWorkers_{0}; // trabajadores vivos
 
-    size_t                        tasksInFlight_{0}; // contador de tareas en vuelo
-    mutex                         waitLock_;  // protege tasksInFlight_
+    lane_t& laneOf(int node, int lane) { return lanes_[node * kNumPriorities + lane]; }
+
+    size_t                        numNodes_;  // nodos NUMA con colas propias
+    vector<int>                   cpuNode_;   // nodo de cada CPU (-1 si no pertenece a ninguno)
+    unique_ptr<lane_t[]>          lanes_;     // colas pendientes por nodo y prioridad
+    TaskSlab                      overflowSlab_; // nodos de los desbordes
+    mutex                         queueLock_; // protege los desbordes y overflowSlab_
+
+    vector<int>                   idleWorkers_; // pila de trabajadores dormidos esperando tarea
+    atomic<size_t>                idleCount_{0}; // tamaño de idleWorkers_, legible sin idleLock_
+    mutex                         idleLock_;  // protege idleWorkers_, available, freeSlots_ y el cierre
+
+    atomic<size_t>                tasksInFlight_{0}; // contador de tareas en vuelo
+    mutex                         waitLock_;  // acompaña a waitCv_
     condition_variable            waitCv_;    // espera hasta que tasksInFlight_ sea cero
 
     atomic<bool>                 done{false}; // indica si el pool ha sido detenido
+    atomic<bool>                  accepting_{true};  // se aceptan tareas desde fuera del pool
+    atomic<bool>                  cancelling_{false}; // cierre con CancelPending en curso
+    vector<Task>                  setAside_;     // tareas programadas durante ese cierre
+    mutex                         setAsideLock_; // protege setAside_
+    mutex                         shutdownLock_; // serializa shutdown y try_shutdown_for
+
+#ifdef TP_METRICS
+    atomic<bool>                  tracing_{false}; // se graban eventos para writeTrace()
+    atomic<uint64_t>              traceEpoch_{0};  // instante desde el que se miden los eventos
+#endif
 
-    /* It is incomplete, there should be more private variables to manage the structures... 
-    * *
-    */
-  
     /* ThreadPools are the type of thing that shouldn't be cloneable, since it's
     * not clear what it means to clone a ThreadPool (should copies of all outstanding
     * functions to be executed be copied?).
@@ -103,4 +371,143 @@ class ThreadPool {
     ThreadPool(const ThreadPool& original) = delete;
     ThreadPool& operator=(const ThreadPool& rhs) = delete;
 };
+
+/**
+ * @brief A set of thunks scheduled on a ThreadPool that can be waited on
+ * (or cancelled) independently of everything else running in the pool.
+ *
+ * ThreadPool::wait() waits for every thunk in the pool; TaskGroup::wait()
+ * only for the ones scheduled through the group. The group must outlive its
+ * thunks, so its destructor waits for them.
+ */
+class TaskGroup {
+  public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool) {}
+
+  /**
+  * Waits for the group's thunks (the ones already cancelled are skipped).
+  */
+    ~TaskGroup() { wait(); }
+
+  /**
+  * Schedules thunk on the pool as part of this group.
+  */
+    template <typename F>
+    void schedule(F&& thunk, Priority priority = Priority::Normal);
+
+  /**
+  * Blocks until every thunk scheduled through the group has run or been
+  * cancelled. Called from a worker of the same pool, it runs other pending
+  * tasks while it waits.
+  */
+    void wait();
+
+  /**
+  * Cancels the group: thunks that have not started yet (and thunks
+  * scheduled afterwards) are discarded without running. Thunks already
+  * running are not interrupted.
+  */
+    void cancel() { cancelled_.store(true); }
+
+    bool cancelled() const { return cancelled_.load(); }
+
+  /**
+  * Number of thunks of the group that have not finished yet.
+  */
+    size_t pending() const { return pending_.load(); }
+
+  private:
+
+    // Tarea del grupo: salta la función si el grupo fue cancelado y
+    // siempre descuenta del contador del grupo, también si se destruye sin
+    // ejecutarse (descartada al cerrar el pool)
+    template <typename F>
+    struct GroupTask {
+        template <typename G>
+        GroupTask(TaskGroup *group, G&& fn) : group(group), fn(forward<G>(fn)) {}
+        GroupTask(GroupTask&& other) noexcept(is_nothrow_move_constructible<F>::value)
+            : group(other.group), fn(move(other.fn)) {
+            other.group = nullptr;
+        }
+        ~GroupTask() { if (group) group->finish(); }
+        void operator()() {
+            TaskGroup *g = group;
+            group = nullptr;
+            if (!g->cancelled_.load()) fn();
+            g->finish();
+        }
+
+        TaskGroup *group;
+        F          fn;
+    };
+
+    void finish();
+
+    ThreadPool&         pool_;               // pool donde corren las tareas
+    atomic<size_t>      pending_{0};         // tareas del grupo sin terminar
+    atomic<bool>        cancelled_{false};   // el grupo fue cancelado
+    atomic<int>         finishing_{0};       // hilos dentro de finish()
+    atomic<int>         waiters_{0};         // hilos bloqueados en cv_
+    mutex               mtx_;                // acompaña a cv_
+    condition_variable  cv_;                 // espera hasta que pending_ sea cero
+
+    TaskGroup(const TaskGroup& original) = delete;
+    TaskGroup& operator=(const TaskGroup& rhs) = delete;
+};
+
+template <typename F>
+void TaskGroup::schedule(F&& thunk, Priority priority) {
+    if (detail::isNullCallable(thunk)) throw invalid_argument("Tarea vacía no permitida");
+    GroupTask<typename decay<F>::type> task(nullptr, forward<F>(thunk));
+    ++pending_;
+    task.group = this;
+    // si schedule() falla, el destructor de la tarea (o de su copia movida)
+    // descuenta lo que se sumó acá
+    pool_.schedule(move(task), priority);
+}
+
+template <typename Range>
+void ThreadPool::schedule_bulk(Range&& thunks, Priority priority) {
+    vector<Task> batch;
+    for (auto&& thunk : thunks) batch.push_back(Task(detail::forwardElement<Range>(thunk)));
+    scheduleBatch(batch, priority);
+}
+
+template <typename F>
+void ThreadPool::schedule_n(size_t count, F&& indexFn, Priority priority) {
+    if (count == 0) return;
+    typedef typename decay<F>::type fn_t;
+    detail::SharedIndexFn<fn_t> *shared = new detail::SharedIndexFn<fn_t>(forward<F>(indexFn));
+    struct releaser {
+        detail::SharedIndexFn<fn_t> *s;
+        ~releaser() { s->release(); }
+    } guard{shared};
+    vector<Task> batch;
+    batch.reserve(count);
+    for (size_t i = 0; i < count; i++) batch.push_back(Task(detail::IndexTask<fn_t>(shared, i)));
+    scheduleBatch(batch, priority);
+}
+
+template <typename F, typename... Args>
+TaskFuture<typename decay<decltype(declval<typename decay<F>::type>()(
+    declval<typename decay<Args>::type>()...))>::type>
+ThreadPool::submit(F&& fn, Args&&... args) {
+    typedef decltype(declval<typename decay<F>::type>()(
+        declval<typename decay<Args>::type>()...)) result_t;
+    static_assert(!is_reference<result_t>::value,
+                  "submit() no admite funciones que devuelven referencias");
+    typedef SubmitState<result_t, typename decay<F>::type, typename decay<Args>::type...> state_t;
+
+    state_t *state = new state_t(this, forward<F>(fn), forward<Args>(args)...);
+    state->retain(); // una referencia para el handle y otra para la tarea
+    detail::SubmitTask task(state);
+    try {
+        schedule(move(task));
+    } catch (...) {
+        // la referencia de la tarea la suelta su destructor
+        state->release();
+        throw;
+    }
+    return TaskFuture<result_t>(state);
+}
 #endif
@@ -0,0 +1,237 @@
+/**
+ * File: tpbench.cc
+ * ----------------
+ * Throughput and latency benchmark for the ThreadPool. Every case runs once
+ * per thread count from 1 to --threads and prints one JSON object per line
+ * with the tasks per second and the p50/p99/p999 schedule-to-start latency,
+ * so that the output of two versions can be compared mechanically.
+ *
+ *   ./tpbench [--threads N] [--tasks M] [--case NAME]
+ *
+ * Cases: empty, empty-bulk (the same tasks through schedule_n), tiny-cpu,
+ * recursive-fan-out, many-producers and mixed-sleep-cpu.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread-pool.h"
+
+using namespace std;
+
+typedef chrono::steady_clock benchClock;
+
+// Latencias de un caso: samples[i] es el tiempo (ns) entre que se programó la
+// tarea i y el momento en que empezó a ejecutarse
+struct latencies {
+    explicit latencies(size_t count) : samples(count), next(0) {}
+
+    void record(size_t i, benchClock::time_point scheduled) {
+        samples[i] = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+            benchClock::now() - scheduled).count();
+    }
+
+    vector<uint64_t> samples;
+    atomic<size_t>   next;    // próximo índice libre (para los casos que lo asignan al ejecutar)
+};
+
+// Trabajo de CPU de duración fija y muy corta (~iters operaciones)
+static atomic<unsigned> sink(0);
+static void spin(unsigned iters) {
+    unsigned x = 2463534242u;
+    for (unsigned i = 0; i < iters; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    sink.store(x, memory_order_relaxed);
+}
+
+static const unsigned kTinyIters = 200;   // ~1µs de CPU
+static const unsigned kSleepEvery = 16;   // en el caso mixto, una de cada tantas duerme
+static const int kFanOut = 4;             // hijos de cada nodo en el caso recursivo
+static const size_t kProducers = 4;       // hilos que programan en el caso many-producers
+
+// Tareas vacías programadas desde un solo hilo
+static size_t emptyCase(ThreadPool& pool, latencies& lat) {
+    size_t n = lat.samples.size();
+    for (size_t i = 0; i < n; i++) {
+        latencies *l = &lat;
+        benchClock::time_point t0 = benchClock::now();
+        pool.schedule([l, i, t0] { l->record(i, t0); });
+    }
+    pool.wait();
+    return n;
+}
+
+// Las mismas tareas vacías, programadas en un único lote con schedule_n
+static size_t emptyBulkCase(ThreadPool& pool, latencies& lat) {
+    size_t n = lat.samples.size();
+    latencies *l = &lat;
+    benchClock::time_point t0 = benchClock::now();
+    pool.schedule_n(n, [l, t0](size_t i) { l->record(i, t0); });
+    pool.wait();
+    return n;
+}
+
+// Tareas con un poco de CPU programadas desde un solo hilo
+static size_t tinyCpuCase(ThreadPool& pool, latencies& lat) {
+    size_t n = lat.samples.size();
+    for (size_t i = 0; i < n; i++) {
+        latencies *l = &lat;
+        benchClock::time_point t0 = benchClock::now();
+        pool.schedule([l, i, t0] {
+            l->record(i, t0);
+            spin(kTinyIters);
+        });
+    }
+    pool.wait();
+    return n;
+}
+
+// Árbol de tareas: cada nodo programa kFanOut hijos hasta la profundidad pedida
+static void fanOutNode(ThreadPool *pool, latencies *lat, int depth, benchClock::time_point t0) {
+    lat->record(lat->next++, t0);
+    if (depth == 0) return;
+    for (int c = 0; c < kFanOut; c++) {
+        benchClock::time_point now = benchClock::now();
+        pool->schedule([pool, lat, depth, now] { fanOutNode(pool, lat, depth - 1, now); });
+    }
+}
+
+// Profundidad del árbol más grande con a lo sumo n nodos, y su cantidad de nodos
+static int fanOutDepth(size_t n, size_t& nodes) {
+    int depth = 0;
+    size_t level = 1;
+    nodes = 1;
+    while (nodes + level * kFanOut <= n) {
+        level *= kFanOut;
+        nodes += level;
+        depth++;
+    }
+    return depth;
+}
+
+static size_t fanOutCase(ThreadPool& pool, latencies& lat) {
+    size_t nodes;
+    int depth = fanOutDepth(lat.samples.size(), nodes);
+    ThreadPool *p = &pool;
+    latencies *l = &lat;
+    benchClock::time_point t0 = benchClock::now();
+    pool.schedule([p, l, depth, t0] { fanOutNode(p, l, depth, t0); });
+    pool.wait();
+    return nodes;
+}
+
+// Tareas vacías programadas a la vez desde kProducers hilos
+static size_t manyProducersCase(ThreadPool& pool, latencies& lat) {
+    size_t perProducer = lat.samples.size() / kProducers;
+    vector<thread> producers;
+    for (size_t p = 0; p < kProducers; p++) {
+        producers.push_back(thread([&pool, &lat, p, perProducer] {
+            latencies *l = &lat;
+            for (size_t k = 0; k < perProducer; k++) {
+                size_t i = p * perProducer + k;
+                benchClock::time_point t0 = benchClock::now();
+                pool.schedule([l, i, t0] { l->record(i, t0); });
+            }
+        }));
+    }
+    for (thread& t : producers) t.join();
+    pool.wait();
+    return perProducer * kProducers;
+}
+
+// Mezcla de tareas de CPU cortas con algunas que duermen (como si esperaran E/S)
+static size_t mixedCase(ThreadPool& pool, latencies& lat) {
+    size_t n = lat.samples.size();
+    for (size_t i = 0; i < n; i++) {
+        latencies *l = &lat;
+        benchClock::time_point t0 = benchClock::now();
+        pool.schedule([l, i, t0] {
+            l->record(i, t0);
+            if (i % kSleepEvery == 0) this_thread::sleep_for(chrono::microseconds(50));
+            else spin(kTinyIters);
+        });
+    }
+    pool.wait();
+    return n;
+}
+
+struct benchCase {
+    string name;
+    SchedulingMode mode;
+    size_t tasksDivisor;  // el caso usa tasks / tasksDivisor tareas
+    function<size_t(ThreadPool&, latencies&)> run;  // devuelve las tareas ejecutadas
+};
+
+static uint64_t percentile(const vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[(size_t)(p * (double)(sorted.size() - 1))];
+}
+
+static void runCase(const benchCase& bc, size_t threads, size_t tasks) {
+    latencies lat(tasks / bc.tasksDivisor);
+    ThreadPool pool(threads, bc.mode);
+    benchClock::time_point start = benchClock::now();
+    size_t ran = bc.run(pool, lat);
+    double secs = chrono::duration<double>(benchClock::now() - start).count();
+    lat.samples.resize(ran);
+    sort(lat.samples.begin(), lat.samples.end());
+    cout << "{\"case\":\"" << bc.name << "\",\"threads\":" << threads << ",\"tasks\":" << ran
+         << ",\"seconds\":" << secs << ",\"tasks_per_sec\":" << (uint64_t)(ran / secs)
+         << ",\"p50_us\":" << percentile(lat.samples, 0.50) / 1000.0
+         << ",\"p99_us\":" << percentile(lat.samples, 0.99) / 1000.0
+         << ",\"p999_us\":" << percentile(lat.samples, 0.999) / 1000.0 << "}" << endl;
+}
+
+int main(int argc, char **argv) {
+    size_t maxThreads = thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+    size_t tasks = 100000;
+    string only;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            maxThreads = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--tasks") == 0 && i + 1 < argc) {
+            tasks = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--case") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else {
+            cerr << "Usage: " << argv[0] << " [--threads N] [--tasks M] [--case NAME]" << endl;
+            return 1;
+        }
+    }
+
+    benchCase cases[] = {
+        {"empty", SchedulingMode::Shared, 1, emptyCase},
+        {"empty-bulk", SchedulingMode::Shared, 1, emptyBulkCase},
+        {"tiny-cpu", SchedulingMode::Shared, 1, tinyCpuCase},
+        {"recursive-fan-out", SchedulingMode::WorkStealing, 1, fanOutCase},
+        {"many-producers", SchedulingMode::Shared, 1, manyProducersCase},
+        {"mixed-sleep-cpu", SchedulingMode::Shared, 10, mixedCase},
+    };
+    bool matched = false;
+    for (const benchCase& bc : cases) {
+        if (!only.empty() && bc.name != only) continue;
+        matched = true;
+        for (size_t threads = 1; threads <= maxThreads; threads++) runCase(bc, threads, tasks);
+    }
+    // un caso mal escrito no tiene que parecer una corrida exitosa
+    if (!matched) {
+        cerr << "Usage: " << argv[0] << " [--threads N] [--tasks M] [--case NAME]" << endl;
+        cerr << "Unknown case \"" << only << "\"; valid cases:";
+        for (const benchCase& bc : cases) cerr << " " << bc.name;
+        cerr << endl;
+        return 1;
+    }
+    return 0;
+}
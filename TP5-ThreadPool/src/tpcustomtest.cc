@@ -15,8 +15,19 @@
 #include <sys/types.h> // used to count the number of threads
 #include <unistd.h>    // used to count the number of threads
 #include <dirent.h>    // for opendir, readdir, closedir
+#include <atomic>
+#include <future>      // for future_error
+#include <memory>
+#include <pthread.h>   // for pthread_getaffinity_np
+#include <sched.h>     // for cpu_set_t
+#include <sys/socket.h> // for socketpair
 
 #include "thread-pool.h"
+#include "parallel.h"
+#include "task-graph.h"
+#if __cplusplus >= 202002L
+#include "pool-coroutine.h"
+#endif
 
 
 using namespace std;
@@ -95,6 +106,570 @@ static void reuseThreadPoolTest() {
     pool.wait();
 }
 
+// Suma recursiva estilo divide y conquista: cada tarea parte su rango y
+// programa las mitades desde adentro del pool
+static void recursiveSum(ThreadPool& pool, const vector<int>& data, size_t start, size_t end,
+                         atomic<long>& total) {
+    if (end - start <= 64) {
+        long sum = 0;
+        for (size_t i = start; i < end; i++) sum += data[i];
+        total += sum;
+        return;
+    }
+    size_t mid = start + (end - start) / 2;
+    pool.schedule([&pool, &data, start, mid, &total] { recursiveSum(pool, data, start, mid, total); });
+    pool.schedule([&pool, &data, mid, end, &total] { recursiveSum(pool, data, mid, end, total); });
+}
+
+static void workStealingFanOutTest() {
+    ThreadPool pool(4, SchedulingMode::WorkStealing);
+    vector<int> data(100000);
+    for (size_t i = 0; i < data.size(); i++) data[i] = i % 100;
+    long expected = 0;
+    for (int x : data) expected += x;
+
+    for (int round = 0; round < 3; round++) {
+        atomic<long> total(0);
+        pool.schedule([&pool, &data, &total] { recursiveSum(pool, data, 0, data.size(), total); });
+        pool.wait();
+        oslock.lock();
+        cout << "Round " << round << ": " << (total == expected ? "ok" : "WRONG") << endl;
+        oslock.unlock();
+    }
+}
+
+// Varios hilos productores programando a la vez, con más tareas de las que
+// entran en la cola circular para ejercitar también la cola de desborde
+static void manyProducersTest() {
+    ThreadPool pool(4);
+    const size_t kProducers = 4;
+    const size_t kTasksPerProducer = 5000;
+    atomic<size_t> executed(0);
+    vector<thread> producers;
+    for (size_t p = 0; p < kProducers; p++) {
+        producers.push_back(thread([&pool, &executed] {
+            for (size_t i = 0; i < kTasksPerProducer; i++) {
+                pool.schedule([&executed] { executed++; });
+            }
+        }));
+    }
+    for (thread& t : producers) t.join();
+    pool.wait();
+    oslock.lock();
+    cout << "Executed " << executed << " of " << kProducers * kTasksPerProducer << " tasks." << endl;
+    oslock.unlock();
+}
+
+// submit(): resultados por valor, tareas void, excepciones y tareas que
+// esperan el resultado de subtareas desde adentro del pool
+static long fib(ThreadPool& pool, int n) {
+    if (n < 12) return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+    TaskFuture<long> left = pool.submit(fib, ref(pool), n - 1);
+    long right = fib(pool, n - 2);
+    return left.get() + right;
+}
+
+static void submitTest() {
+    ThreadPool pool(2);
+    TaskFuture<int> sum = pool.submit([](int a, int b) { return a + b; }, 20, 22);
+    TaskFuture<string> text = pool.submit([] { return string("submit"); });
+    atomic<bool> ran(false);
+    TaskFuture<void> nothing = pool.submit([&ran] { ran = true; });
+    TaskFuture<int> failing = pool.submit([]() -> int { throw runtime_error("boom"); });
+
+    oslock.lock();
+    cout << "sum = " << sum.get() << ", text = " << text.get() << endl;
+    nothing.get();
+    cout << "void task ran: " << (ran ? "yes" : "no") << endl;
+    try {
+        failing.get();
+        cout << "exception lost" << endl;
+    } catch (const runtime_error& e) {
+        cout << "exception propagated: " << e.what() << endl;
+    }
+    oslock.unlock();
+
+    for (SchedulingMode mode : {SchedulingMode::Shared, SchedulingMode::WorkStealing}) {
+        ThreadPool nested(2, mode);
+        long result = nested.submit(fib, ref(nested), 22).get();
+        oslock.lock();
+        cout << "fib(22) = " << result << (result == 17711 ? " (ok)" : " (WRONG)") << endl;
+        oslock.unlock();
+    }
+}
+
+// Tareas que solo se pueden mover (no copiar) y tareas más grandes que el
+// buffer interno de Task
+struct MoveOnlyTask {
+    unique_ptr<int> value;
+    atomic<int> *sum;
+    void operator()() { *sum += *value; }
+};
+
+static void moveOnlyTasksTest() {
+    ThreadPool pool(4);
+    atomic<int> sum(0);
+    for (int i = 1; i <= 100; i++) {
+        pool.schedule(MoveOnlyTask{unique_ptr<int>(new int(i)), &sum});
+    }
+    char big[256];
+    memset(big, 1, sizeof(big));
+    for (int i = 0; i < 100; i++) {
+        pool.schedule([big, &sum] { sum += big[0] + big[sizeof(big) - 1]; });
+    }
+    pool.wait();
+    oslock.lock();
+    cout << "sum = " << sum << (sum == 5050 + 200 ? " (ok)" : " (WRONG)") << endl;
+    oslock.unlock();
+}
+
+// parallel_for / parallel_reduce, incluyendo una operación no conmutativa
+// y un parallel_for anidado dentro de una tarea del pool
+static void parallelAlgorithmsTest() {
+    ThreadPool pool(4, SchedulingMode::WorkStealing);
+    const int n = 100000;
+    vector<long> squares(n);
+    parallel_for(pool, 0, n, 0, [&squares](int i) { squares[i] = (long)i * i; });
+    long expected = 0;
+    for (int i = 0; i < n; i++) expected += (long)i * i;
+    long total = parallel_reduce(pool, squares, 0L, [](long a, long b) { return a + b; });
+
+    vector<string> words;
+    for (int i = 0; i < 26; i++) words.push_back(string(1, (char)('a' + i)));
+    string joined = parallel_reduce(pool, words, string(), [](const string& a, const string& b) { return a + b; });
+
+    TaskFuture<long> nested = pool.submit([&pool] {
+        vector<int> ones(1000, 1);
+        atomic<long> count(0);
+        parallel_for(pool, (size_t)0, ones.size(), 16, [&ones, &count](size_t i) { count += ones[i]; });
+        return count.load();
+    });
+
+    oslock.lock();
+    cout << "sum of squares: " << (total == expected ? "ok" : "WRONG") << endl;
+    cout << "joined: " << joined << endl;
+    cout << "nested count: " << nested.get() << endl;
+    oslock.unlock();
+}
+
+// Dos grupos independientes en el mismo pool: esperar al grupo corto no
+// espera al largo, y cancelar un grupo descarta las tareas que no empezaron
+static void taskGroupTest() {
+    ThreadPool pool(2);
+    TaskGroup batch(pool);
+    TaskGroup interactive(pool);
+    atomic<int> batchDone(0);
+    batch.schedule([&batchDone] { sleep_for(500); batchDone++; });
+    interactive.schedule([] { sleep_for(10); });
+    interactive.wait();
+    oslock.lock();
+    cout << "interactive group done, batch pending: " << batch.pending() << endl;
+    oslock.unlock();
+    batch.wait();
+
+    atomic<bool> release(false);
+    atomic<int> ran(0);
+    ThreadPool single(1);
+    single.schedule([&release] { while (!release) sleep_for(1); });
+    TaskGroup cancelled(single);
+    for (int i = 0; i < 10; i++) cancelled.schedule([&ran] { ran++; });
+    cancelled.cancel();
+    release = true;
+    cancelled.wait();
+    oslock.lock();
+    cout << "batch tasks run: " << batchDone << ", cancelled tasks run: " << ran << endl;
+    oslock.unlock();
+}
+
+// Con el único trabajador ocupado se encolan tareas de las tres prioridades;
+// al liberarlo deben salir primero las High, sin dejar de lado a las demás
+static void priorityTest() {
+    ThreadPool pool(1);
+    atomic<bool> release(false);
+    mutex orderLock;
+    string order;
+    pool.schedule([&release] { while (!release) sleep_for(1); });
+    for (int i = 0; i < 8; i++) {
+        pool.schedule([&] { lock_guard<mutex> lg(orderLock); order += 'L'; }, Priority::Low);
+        pool.schedule([&] { lock_guard<mutex> lg(orderLock); order += 'N'; }, Priority::Normal);
+        pool.schedule([&] { lock_guard<mutex> lg(orderLock); order += 'H'; }, Priority::High);
+    }
+    release = true;
+    pool.wait();
+    oslock.lock();
+    cout << "execution order: " << order << endl;
+    oslock.unlock();
+}
+
+// Pool elástico: crece mientras hay tareas encoladas y vuelve al mínimo
+// cuando los trabajadores quedan inactivos más de idleTimeout
+static void elasticTest() {
+    ElasticConfig config(1, 4);
+    config.idleTimeout = chrono::milliseconds(50);
+    ThreadPool pool(config);
+    for (int i = 0; i < 8; i++) pool.schedule([] { sleep_for(100); });
+    sleep_for(20);
+    size_t busy = pool.size();
+    pool.wait();
+    sleep_for(300);
+    size_t idle = pool.size();
+    for (int i = 0; i < 4; i++) pool.schedule([] { sleep_for(10); });
+    pool.wait();
+
+    // Con mínimo 0 una sola tarea (por debajo de spawnQueueDepth) tiene que
+    // lanzar un trabajador, y los que se retiran mientras se programa no
+    // pueden dejar tareas sin ejecutar
+    ElasticConfig lazy(0, 4);
+    lazy.spawnQueueDepth = 4;
+    lazy.idleTimeout = chrono::milliseconds(1);
+    ThreadPool lazyPool(lazy);
+    size_t before = lazyPool.size();
+    atomic<int> ran(0);
+    for (int round = 0; round < 200; round++) {
+        lazyPool.schedule([&ran] { ++ran; });
+        lazyPool.wait();
+        sleep_for(round % 3);
+    }
+    oslock.lock();
+    cout << "workers under load: " << busy << ", after idling: " << idle << endl;
+    cout << "min 0 pool workers at start: " << before << ", tasks run: " << ran << "/200" << endl;
+    oslock.unlock();
+}
+
+// Métricas: cada tarea ejecutada aparece una vez en los histogramas, en los
+// contadores por trabajador y en la traza (solo si se compiló con TP_METRICS)
+static void metricsTest() {
+    ThreadPool pool(kNumThreads, SchedulingMode::WorkStealing);
+    pool.startTrace();
+    for (int i = 0; i < 100; i++) {
+        pool.schedule([&pool] {
+            for (int j = 0; j < 9; j++) pool.schedule([] {});
+        });
+    }
+    pool.wait();
+    pool.stopTrace();
+    PoolMetrics m = pool.metrics();
+    ostringstream trace;
+    pool.writeTrace(trace);
+    size_t events = 0;
+    for (size_t pos = trace.str().find("\"ph\":\"X\""); pos != string::npos;
+         pos = trace.str().find("\"ph\":\"X\"", pos + 1)) events++;
+    oslock.lock();
+    if (m.enabled) {
+        cout << "tasks run: " << m.tasksRun() << ", queue-wait samples: " << m.queueWait.count()
+             << ", run-time samples: " << m.runTime.count() << ", trace events: " << events
+             << ", queue depth: " << m.queueDepth << endl;
+    } else {
+        cout << "metrics compiled out, trace events: " << events
+             << ", queue depth: " << m.queueDepth << endl;
+    }
+    oslock.unlock();
+}
+
+// Semáforo: try_wait no bloquea, wait_for vence sin señal y despierta con ella
+static void semaphoreTest() {
+    Semaphore sem(1);
+    bool first = sem.try_wait();
+    bool second = sem.try_wait();
+    bool timedOut = !sem.wait_for(chrono::milliseconds(20));
+    thread signaler([&sem] { sleep_for(10); sem.signal(); });
+    bool woken = sem.wait_for(chrono::milliseconds(5000));
+    signaler.join();
+    oslock.lock();
+    cout << "try_wait: " << first << second << ", timed out: " << timedOut
+         << ", woken by signal: " << woken << endl;
+    oslock.unlock();
+}
+
+// Ubicación: con pinToCores cada tarea corre en un hilo fijado a una sola
+// CPU; con dos nodos NUMA (simulados sobre la misma CPU) cada nodo tiene sus
+// colas y todas las tareas se ejecutan igual
+static void placementTest() {
+    Placement pinned = Placement::pinToCores();
+    atomic<int> singleCpu(0);
+    {
+        ThreadPool pool(kNumThreads, SchedulingMode::Shared, pinned);
+        for (int i = 0; i < 20; i++) {
+            pool.schedule([&singleCpu] {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+                if (CPU_COUNT(&set) == 1) singleCpu++;
+            });
+        }
+        pool.wait();
+    }
+
+    Placement numa;
+    numa.numa = true;
+    int cpu = pinned.cpuSets[0][0];
+    numa.numaNodes = {{cpu}, {cpu}};
+    atomic<int> ran(0);
+    ThreadPool pool(kNumThreads, SchedulingMode::WorkStealing, numa);
+    for (int i = 0; i < 100; i++) {
+        pool.schedule([&pool, &ran] {
+            ran++;
+            for (int j = 0; j < 9; j++) pool.schedule([&ran] { ran++; });
+        });
+    }
+    pool.wait();
+    oslock.lock();
+    cout << "tasks pinned to one CPU: " << singleCpu << "/20, nodes: " << pool.numaNodes()
+         << ", tasks run: " << ran << endl;
+    oslock.unlock();
+}
+
+// Lotes: schedule_bulk con funciones copiadas y con callables solo movibles,
+// schedule_n con índices, y un lote con una tarea vacía que no programa nada
+static void bulkTest() {
+    ThreadPool pool(kNumThreads);
+    atomic<int> copied(0);
+    vector<function<void(void)>> thunks(1000, [&copied] { copied++; });
+    pool.schedule_bulk(thunks);
+
+    struct owner {
+        unique_ptr<int> value;
+        atomic<int>    *total;
+        void operator()() { *total += *value; }
+    };
+    atomic<int> moved(0);
+    vector<owner> once;
+    for (int i = 0; i < 100; i++) once.push_back(owner{unique_ptr<int>(new int(1)), &moved});
+    pool.schedule_bulk(move(once));
+
+    atomic<long> indexSum(0);
+    pool.schedule_n(1000, [&indexSum](size_t i) { indexSum += (long)i; });
+
+    bool rejected = false;
+    thunks.push_back(function<void(void)>());
+    try {
+        pool.schedule_bulk(thunks);
+    } catch (const invalid_argument&) {
+        rejected = true;
+    }
+    pool.wait();
+    oslock.lock();
+    cout << "copied: " << copied << ", moved: " << moved << ", index sum: " << indexSum
+         << ", batch with empty thunk rejected: " << rejected << endl;
+    oslock.unlock();
+}
+
+#if __cplusplus >= 202002L
+static CoTask<int> square(ThreadPool& pool, int x) {
+    co_await pool;
+    co_return x * x;
+}
+
+static CoTask<int> sumOfSquares(ThreadPool& pool, int a, int b) {
+    co_await pool;
+    int first = co_await square(pool, a);
+    int second = co_await square(pool, b);
+    co_return first + second;
+}
+
+static CoTask<string> readPipe(ThreadPool& pool, IoReactor& reactor, int fd) {
+    co_await pool;
+    co_await reactor.readable(fd);
+    char buf[16] = {};
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    co_return string(buf, n > 0 ? n : 0);
+}
+
+static CoTask<bool> writeSocket(ThreadPool& pool, IoReactor& reactor, int fd) {
+    co_await pool;
+    uint32_t events = co_await reactor.writable(fd);
+    co_return (events & EPOLLOUT) && write(fd, "ping", 4) == 4;
+}
+
+static CoTask<bool> secondReaderRejected(ThreadPool& pool, IoReactor& reactor, int fd) {
+    co_await pool;
+    try {
+        co_await reactor.readable(fd);
+    } catch (const system_error& e) {
+        co_return e.code().value() == EBUSY;
+    }
+    co_return false;
+}
+
+static CoTask<long> sleepOnReactor(ThreadPool& pool, IoReactor& reactor) {
+    co_await pool;
+    auto start = chrono::steady_clock::now();
+    co_await reactor.sleep_for(chrono::milliseconds(20));
+    co_return (long)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+}
+
+// Corrutinas: co_await pool las pasa a un trabajador, un CoTask puede
+// esperar a otro, y una espera de E/S no ocupa al único trabajador
+static void coroutinesTest() {
+    ThreadPool pool(1);
+    int sum = sumOfSquares(pool, 3, 4).get();
+
+    IoReactor reactor(pool);
+    int fds[2];
+    if (pipe(fds) != 0) return;
+    string received;
+    CoTask<string> reader = readPipe(pool, reactor, fds[0]);
+    thread consumer([&reader, &received] { received = reader.get(); });
+    sleep_for(20);
+    atomic<bool> otherRan(false);
+    pool.schedule([&otherRan] { otherRan = true; });
+    pool.wait();
+    bool ranWhileWaiting = otherRan;
+    if (write(fds[1], "hello", 5) != 5) return;
+    consumer.join();
+    close(fds[0]);
+    close(fds[1]);
+    bool slept = sleepOnReactor(pool, reactor).get() >= 20;
+
+    // Un lector y un escritor esperando sobre el mismo socket: el escritor
+    // no reemplaza al lector, y un segundo lector se rechaza con EBUSY
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) return;
+    CoTask<string> sockReader = readPipe(pool, reactor, sv[0]);
+    string fromSocket;
+    thread sockConsumer([&sockReader, &fromSocket] { fromSocket = sockReader.get(); });
+    sleep_for(20);
+    bool busy = secondReaderRejected(pool, reactor, sv[0]).get();
+    bool wrote = writeSocket(pool, reactor, sv[0]).get();
+    if (write(sv[1], "pong", 4) != 4) return;
+    sockConsumer.join();
+    char echoed[8] = {};
+    bool echoedPing = read(sv[1], echoed, 4) == 4 && string(echoed) == "ping";
+    close(sv[0]);
+    close(sv[1]);
+
+    oslock.lock();
+    cout << "sum of squares: " << sum << ", other task ran while reader waited: " << ranWhileWaiting
+         << ", read: " << received << ", slept on reactor: " << slept << endl;
+    cout << "same socket: reader got " << fromSocket << ", writer sent ping: " << (wrote && echoedPing)
+         << ", second reader rejected: " << busy << endl;
+    oslock.unlock();
+}
+#endif
+
+// Grafo de tareas: un diamante respeta el orden de sus aristas, un pipeline
+// de tres etapas avanza por elemento sin barreras, un ciclo se rechaza y una
+// excepción saltea los nodos pendientes y se relanza en wait()
+static void taskGraphTest() {
+    ThreadPool pool(kNumThreads);
+    mutex logLock;
+    string log;
+    auto note = [&](char c) { return [&, c] { lock_guard<mutex> lg(logLock); log += c; }; };
+    TaskGraph diamond(pool);
+    size_t a = diamond.add(note('A'));
+    size_t b = diamond.then(a, note('B'));
+    size_t c = diamond.then(a, note('C'));
+    size_t d = diamond.add(note('D'));
+    diamond.precede(b, d);
+    diamond.precede(c, d);
+    diamond.run();
+    diamond.wait();
+    bool diamondOk = log.size() == 4 && log[0] == 'A' && log[3] == 'D';
+
+    const int items = 50;
+    vector<int> stage(items, 0);
+    TaskGraph pipeline(pool);
+    for (int i = 0; i < items; i++) {
+        size_t load = pipeline.add([&stage, i] { stage[i] = i; });
+        size_t twice = pipeline.then(load, [&stage, i] { stage[i] *= 2; });
+        pipeline.then(twice, [&stage, i] { stage[i] += 1; });
+    }
+    pipeline.run();
+    pipeline.wait();
+    long total = 0;
+    for (int v : stage) total += v;
+
+    TaskGraph cycle(pool);
+    size_t x = cycle.add([] {});
+    size_t y = cycle.then(x, [] {});
+    cycle.precede(y, x);
+    bool cycleRejected = false;
+    try {
+        cycle.run();
+    } catch (const invalid_argument&) {
+        cycleRejected = true;
+    }
+
+    atomic<int> after(0);
+    TaskGraph failing(pool);
+    size_t bad = failing.add([] { throw runtime_error("falla"); });
+    failing.then(bad, [&after] { after++; });
+    string error;
+    failing.run();
+    try {
+        failing.wait();
+    } catch (const runtime_error& e) {
+        error = e.what();
+    }
+
+    oslock.lock();
+    cout << "diamond order ok: " << diamondOk << ", pipeline total: " << total
+         << ", cycle rejected: " << cycleRejected << ", error: " << error
+         << ", skipped successor ran: " << after << endl;
+    oslock.unlock();
+}
+
+static void shutdownTest() {
+    atomic<int> drained(0);
+    size_t leftOver;
+    {
+        ThreadPool pool(kNumThreads);
+        for (int i = 0; i < 100; i++) pool.schedule([&drained] { drained++; });
+        leftOver = pool.shutdown().size();
+    }
+
+    // un solo trabajador, bloqueado hasta que release se ponga en true
+    atomic<int> ran(0);
+    atomic<bool> started(false), release(false);
+    size_t cancelled;
+    bool rejected = false, broken = false;
+    {
+        ThreadPool pool(1);
+        TaskGroup group(pool);
+        pool.schedule([&] {
+            started = true;
+            while (!release) this_thread::sleep_for(chrono::milliseconds(1));
+            pool.schedule([&ran] { ran++; }); // programada durante el cierre: se aparta
+        });
+        while (!started) this_thread::sleep_for(chrono::milliseconds(1));
+        for (int i = 0; i < 5; i++) pool.schedule([&ran] { ran++; });
+        TaskFuture<int> future = pool.submit([] { return 1; });
+        group.schedule([&ran] { ran++; });
+        thread releaser([&release] {
+            this_thread::sleep_for(chrono::milliseconds(50));
+            release = true;
+        });
+        cancelled = pool.shutdown(ShutdownMode::CancelPending).size();
+        releaser.join();
+        try {
+            pool.schedule([] {});
+        } catch (const runtime_error&) {
+            rejected = true;
+        }
+        try {
+            future.get();
+        } catch (const future_error& e) {
+            broken = e.code() == future_errc::broken_promise;
+        }
+        group.wait();
+    }
+
+    bool timedOut, stopped;
+    {
+        ThreadPool pool(1);
+        pool.schedule([] { this_thread::sleep_for(chrono::milliseconds(200)); });
+        timedOut = !pool.try_shutdown_for(chrono::milliseconds(10));
+        stopped = pool.try_shutdown_for(chrono::milliseconds(5000));
+    }
+
+    oslock.lock();
+    cout << "drained: " << drained << ", left over: " << leftOver
+         << ", cancelled: " << cancelled << ", cancelled ran: " << ran
+         << ", rejected after shutdown: " << rejected << ", future broken: " << broken
+         << ", timed out: " << timedOut << ", stopped: " << stopped << endl;
+    oslock.unlock();
+}
+
 struct testEntry {
     string flag;
     function<void(void)> testfn;
@@ -106,6 +681,23 @@ static void buildMap(map<string, function<void(void)>>& testFunctionMap) {
         {"--single-thread-single-wait", singleThreadSingleWaitTest},
         {"--no-threads-double-wait", noThreadsDoubleWaitTest},
         {"--reuse-thread-pool", reuseThreadPoolTest},
+        {"--work-stealing-fan-out", workStealingFanOutTest},
+        {"--many-producers", manyProducersTest},
+        {"--submit", submitTest},
+        {"--move-only-tasks", moveOnlyTasksTest},
+        {"--parallel-algorithms", parallelAlgorithmsTest},
+        {"--task-group", taskGroupTest},
+        {"--priority", priorityTest},
+        {"--elastic", elasticTest},
+        {"--metrics", metricsTest},
+        {"--semaphore", semaphoreTest},
+        {"--placement", placementTest},
+        {"--bulk", bulkTest},
+        {"--task-graph", taskGraphTest},
+        {"--shutdown", shutdownTest},
+#if __cplusplus >= 202002L
+        {"--coroutines", coroutinesTest},
+#endif
         {"--s", simpleTest},
     };
 